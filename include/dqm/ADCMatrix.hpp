@@ -0,0 +1,218 @@
+/**
+ * @file ADCMatrix.hpp Decoded ADC values of a TriggerRecord shared by all the modules
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ADCMATRIX_HPP_
+#define DQM_INCLUDE_DQM_ADCMATRIX_HPP_
+
+// DQM
+#include "dqm/AlignedAllocator.hpp"
+#include "dqm/Constants.hpp"
+#include "dqm/DQMFormats.hpp"
+#include "dqm/Decoder.hpp"
+#include "dqm/DQMLogging.hpp"
+#include "dqm/FormatUtils.hpp"
+#include "dqm/LinkFrames.hpp"
+#include "dqm/Pipeline.hpp"
+#include "dqm/WorkerPool.hpp"
+
+#include "daqdataformats/TriggerRecord.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+using logging::TLVL_WORK_STEPS;
+
+/**
+ * All the ADC values of a TriggerRecord in a single contiguous buffer
+ * with layout [link][channel][sample]. Every channel starts at the beginning
+ * of a cache line. The frames are unpacked only once and then the matrix is
+ * read by every module that runs on the same record
+ */
+class ADCMatrix
+{
+public:
+  /**
+   * @brief Allocate the buffer
+   * @param links Element ids of the links, sorted
+   * @param nsamples Number of samples (frames) for each link
+   */
+  void allocate(const std::vector<int>& links, const std::vector<size_t>& nsamples);
+
+  size_t get_num_links() const { return m_links.size(); }
+  int get_link(size_t slot) const { return m_links[slot]; }
+  const std::vector<int>& get_links() const { return m_links; }
+
+  /**
+   * @brief Position of a link in the matrix or -1 if the link is not present
+   */
+  int get_slot(int link) const { return m_index.get_slot(link); }
+
+  size_t get_num_samples(size_t slot) const { return m_nsamples[slot]; }
+  /**
+   * @brief Number of samples that every link has, the equivalent of make_same_size
+   */
+  size_t get_min_samples() const { return m_min_samples; }
+  size_t get_stride() const { return m_stride; }
+
+  const uint16_t* row(size_t slot, int ch) const { return m_data.data() + (slot * CHANNELS_PER_LINK + ch) * m_stride; }
+  uint16_t* row(size_t slot, int ch) { return m_data.data() + (slot * CHANNELS_PER_LINK + ch) * m_stride; }
+
+private:
+  std::vector<int> m_links;
+  LinkIndex m_index;
+  std::vector<size_t> m_nsamples;
+  size_t m_min_samples = 0;
+  size_t m_stride = 0;
+  aligned_vector<uint16_t> m_data;
+};
+
+void
+ADCMatrix::allocate(const std::vector<int>& links, const std::vector<size_t>& nsamples)
+{
+  m_links = links;
+  m_index = LinkIndex(links);
+  m_nsamples = nsamples;
+  m_min_samples = nsamples.empty() ? 0 : *std::min_element(nsamples.begin(), nsamples.end());
+  size_t max_samples = nsamples.empty() ? 0 : *std::max_element(nsamples.begin(), nsamples.end());
+
+  // Pad the rows so that each channel starts on a cache line
+  m_stride = pad_to_cache_line<uint16_t>(max_samples);
+  m_data.assign(m_links.size() * CHANNELS_PER_LINK * m_stride, 0);
+}
+
+/**
+ * @brief Unpack all the frames into an ADCMatrix, each link is a separate task for the workers
+ */
+template<class T>
+std::shared_ptr<ADCMatrix>
+make_adc_matrix(const LinkFrames<T>& frames, WorkerPool& workers)
+{
+  std::vector<int> links;
+  std::vector<size_t> nsamples;
+  links.reserve(frames.size());
+  nsamples.reserve(frames.size());
+  for (const auto& [link, vec] : frames) {
+    links.push_back(link);
+    nsamples.push_back(vec.size());
+  }
+
+  auto matrix = std::make_shared<ADCMatrix>();
+  matrix->allocate(links, nsamples);
+
+  // Frames are unpacked in blocks and then transposed into the rows of
+  // the matrix so that the writes for each channel are contiguous
+  workers.parallel_for(frames.size(), [&](size_t slot) {
+    constexpr size_t block_size = 32;
+    aligned_vector<uint16_t> block(block_size * CHANNELS_PER_LINK);
+    const auto& vec = (frames.begin() + slot)->second;
+    for (size_t first = 0; first < vec.size(); first += block_size) {
+      size_t nframes = std::min(block_size, vec.size() - first);
+      for (size_t iframe = 0; iframe < nframes; ++iframe) {
+        unpack_frame<T>(vec[first + iframe], block.data() + iframe * CHANNELS_PER_LINK);
+      }
+      for (int ich = 0; ich < CHANNELS_PER_LINK; ++ich) {
+        uint16_t* adcs = matrix->row(slot, ich) + first;
+        for (size_t iframe = 0; iframe < nframes; ++iframe) {
+          adcs[iframe] = block[iframe * CHANNELS_PER_LINK + ich];
+        }
+      }
+    }
+  });
+  return matrix;
+}
+
+/**
+ * Keeps the ADCMatrix of the records that are being processed so that
+ * when several modules run on the same record (for example TRs from DF)
+ * the frames are decoded and unpacked only once.
+ * Entries are removed when the record they belong to is destroyed
+ */
+class ADCMatrixCache
+{
+public:
+  /**
+   * @brief Get the ADCMatrix for a record, decoding it if needed
+   *
+   *        Returns nullptr if the data is not valid
+   */
+  template<class T>
+  std::shared_ptr<const ADCMatrix> get(std::shared_ptr<daqdataformats::TriggerRecord> record, const DQMArgs& args);
+
+private:
+  struct Entry
+  {
+    std::weak_ptr<daqdataformats::TriggerRecord> record;
+    std::type_index type;
+    int max_frames;
+    std::shared_future<std::shared_ptr<const ADCMatrix>> matrix;
+  };
+
+  std::mutex m_mutex;
+  std::vector<Entry> m_entries;
+};
+
+template<class T>
+std::shared_ptr<const ADCMatrix>
+ADCMatrixCache::get(std::shared_ptr<daqdataformats::TriggerRecord> record, const DQMArgs& args)
+{
+  int max_frames = args.max_frames;
+  std::promise<std::shared_ptr<const ADCMatrix>> promise;
+  std::shared_future<std::shared_ptr<const ADCMatrix>> existing;
+  bool found = false;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(),
+                                   [](const Entry& entry) { return entry.record.expired(); }),
+                    m_entries.end());
+    for (const auto& entry : m_entries) {
+      if (entry.record.lock() == record && entry.type == std::type_index(typeid(T)) &&
+          entry.max_frames == max_frames) {
+        existing = entry.matrix;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      m_entries.push_back({ record, std::type_index(typeid(T)), max_frames, promise.get_future().share() });
+    }
+  }
+
+  // Another module is already decoding (or has decoded) this record
+  if (found) {
+    TLOG_DEBUG(TLVL_WORK_STEPS) << "Reusing the ADC matrix of the record";
+    return existing.get();
+  }
+
+  // Decoding happens outside of the lock so that different records can be
+  // decoded at the same time. If it throws, the modules waiting for this
+  // record get the same exception instead of a broken promise
+  std::shared_ptr<const ADCMatrix> matrix;
+  try {
+    auto frames = decode<T>(record, max_frames, args.link_index);
+    StaticPipeline<T, RemoveEmpty, CheckEmpty, CheckTimestampsAligned, AlignTimestamps> pipe;
+    if (pipe(frames)) {
+      matrix = make_adc_matrix<T>(frames, *args.workers);
+    }
+  } catch (...) {
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+  promise.set_value(matrix);
+  return matrix;
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_ADCMATRIX_HPP_
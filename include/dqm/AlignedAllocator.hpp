@@ -0,0 +1,78 @@
+/**
+ * @file AlignedAllocator.hpp Allocator for buffers aligned to cache lines
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALIGNEDALLOCATOR_HPP_
+#define DQM_INCLUDE_DQM_ALIGNEDALLOCATOR_HPP_
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief Round n up so that n elements of type T fill whole cache lines, used
+ *        for the rows of buffers so that each one starts on a cache line
+ */
+template<class T>
+constexpr size_t
+pad_to_cache_line(size_t n)
+{
+  constexpr size_t per_line = CACHE_LINE_SIZE / sizeof(T);
+  return (n + per_line - 1) / per_line * per_line;
+}
+
+/**
+ * Minimal allocator so that std::vector can be used for buffers that
+ * have to start at the beginning of a cache line (and are therefore
+ * aligned for any vector instruction set)
+ */
+template<class T, size_t Alignment = CACHE_LINE_SIZE>
+class AlignedAllocator
+{
+public:
+  using value_type = T;
+
+  template<class U>
+  struct rebind
+  {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept = default;
+  template<class U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept // NOLINT(runtime/explicit)
+  {}
+
+  T* allocate(size_t n)
+  {
+    // std::aligned_alloc requires the size to be a multiple of the alignment
+    size_t bytes = (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+    void* ptr = std::aligned_alloc(Alignment, bytes);
+    if (ptr == nullptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(ptr);
+  }
+
+  void deallocate(T* ptr, size_t) noexcept { std::free(ptr); }
+
+  template<class U>
+  bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+  template<class U>
+  bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+template<class T>
+using aligned_vector = std::vector<T, AlignedAllocator<T>>;
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_ALIGNEDALLOCATOR_HPP_
@@ -0,0 +1,205 @@
+/**
+ * @file ChannelGroups.hpp Sums of the ADC values of groups of channels (planes, FEMBs or ASICs)
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_CHANNELGROUPS_HPP_
+#define DQM_INCLUDE_DQM_CHANNELGROUPS_HPP_
+
+#include "dqm/ADCMatrix.hpp"
+#include "dqm/ChannelMap.hpp"
+#include "dqm/Constants.hpp"
+#include "dqm/Issues.hpp"
+#include "dqm/LinkFrames.hpp"
+#include "dqm/algs/Kernels.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * How the channels are grouped. FEMBs and ASICs follow the order of the
+ * channels in the frames: every link has 2 FEMBs of 128 channels and each
+ * FEMB has 8 ASICs of 16 channels
+ */
+enum class ChannelGrouping
+{
+  kPlane,
+  kFEMB,
+  kASIC
+};
+
+/**
+ * @brief Parse "plane", "femb" or "asic", anything else is not valid
+ */
+std::optional<ChannelGrouping>
+parse_channel_grouping(const std::string& name)
+{
+  if (name == "plane") {
+    return ChannelGrouping::kPlane;
+  }
+  if (name == "femb") {
+    return ChannelGrouping::kFEMB;
+  }
+  if (name == "asic") {
+    return ChannelGrouping::kASIC;
+  }
+  return std::nullopt;
+}
+
+/**
+ * Precomputed plan to add the ADC values of every group of channels. For
+ * each link a table gives the group of each of its channels, and from it
+ * the list of (link, channel) of every group ordered by link, so that
+ * summing a group is a row addition for each of its channels with only a
+ * link lookup when the link changes. The plan is built once, the channel
+ * map is not traversed for every record
+ */
+class ChannelGroups
+{
+public:
+  static constexpr int s_channels_per_femb = 128;
+  static constexpr int s_channels_per_asic = 16;
+
+  ChannelGroups() = default;
+
+  /**
+   * @brief Groups for the links of link_idx. For FEMBs and ASICs the plan is
+   *        complete, for planes set_planes has to be called with the channel map
+   */
+  ChannelGroups(ChannelGrouping grouping, const LinkIndex& index);
+
+  /**
+   * @brief Fill the plane of every channel from a channel map that is already filled
+   */
+  void set_planes(const ChannelMap& map);
+
+  ChannelGrouping get_grouping() const { return m_grouping; }
+  size_t get_num_groups() const { return m_members.size(); }
+  bool is_ready() const { return m_ready; }
+
+  /**
+   * @brief Group of channel ch of a link slot of the index, -1 if it has none
+   */
+  int get_group(size_t link_slot, int ch) const { return m_table[link_slot * CHANNELS_PER_LINK + ch]; }
+
+  /**
+   * @brief Link of a FEMB or ASIC group and the number of the FEMB or ASIC in the link
+   */
+  std::pair<int, int> get_location(size_t group) const;
+
+  /**
+   * @brief sum[i] += value of sample i of every channel of the group, for i < nsamples
+   */
+  void add(const ADCMatrix& matrix, size_t nsamples, size_t group, double* sum) const;
+
+private:
+  void build_members();
+
+  ChannelGrouping m_grouping = ChannelGrouping::kPlane;
+  LinkIndex m_index;
+  // [link slot][channel] -> group
+  std::vector<int> m_table;
+  // (link, channel) of every group, ordered by link
+  std::vector<std::vector<std::pair<int, int>>> m_members;
+  bool m_ready = false;
+};
+
+ChannelGroups::ChannelGroups(ChannelGrouping grouping, const LinkIndex& index)
+  : m_grouping(grouping)
+  , m_index(index)
+  , m_table(index.size() * CHANNELS_PER_LINK, -1)
+{
+  if (m_grouping == ChannelGrouping::kPlane) {
+    // Planes 0, 1 and 2, the channels are assigned when the map is known
+    m_members.resize(3);
+    return;
+  }
+  int per_group = m_grouping == ChannelGrouping::kFEMB ? s_channels_per_femb : s_channels_per_asic;
+  int per_link = CHANNELS_PER_LINK / per_group;
+  for (size_t slot = 0; slot < m_index.size(); ++slot) {
+    for (int ich = 0; ich < CHANNELS_PER_LINK; ++ich) {
+      m_table[slot * CHANNELS_PER_LINK + ich] = slot * per_link + ich / per_group;
+    }
+  }
+  m_members.resize(m_index.size() * per_link);
+  build_members();
+}
+
+void
+ChannelGroups::set_planes(const ChannelMap& map)
+{
+  std::fill(m_table.begin(), m_table.end(), -1);
+  for (const auto& [link, channels] : map.m_map_rev) {
+    int slot = m_index.get_slot(link);
+    if (slot < 0) {
+      continue;
+    }
+    for (const auto& [ich, plane_channel] : channels) {
+      // Only the three planes are summed, the sum of all the channels is
+      // computed from them
+      int plane = plane_channel.first;
+      if (plane < 0 || plane > 2) {
+        continue;
+      }
+      m_table[slot * CHANNELS_PER_LINK + ich] = plane;
+    }
+  }
+  build_members();
+}
+
+void
+ChannelGroups::build_members()
+{
+  for (auto& members : m_members) {
+    members.clear();
+  }
+  for (size_t slot = 0; slot < m_index.size(); ++slot) {
+    for (int ich = 0; ich < CHANNELS_PER_LINK; ++ich) {
+      int group = get_group(slot, ich);
+      if (group >= 0) {
+        m_members[group].push_back({ m_index.get_link(slot), ich });
+      }
+    }
+  }
+  m_ready = true;
+}
+
+std::pair<int, int>
+ChannelGroups::get_location(size_t group) const
+{
+  int per_link = m_grouping == ChannelGrouping::kFEMB ? CHANNELS_PER_LINK / s_channels_per_femb
+                                                      : CHANNELS_PER_LINK / s_channels_per_asic;
+  return { m_index.get_link(group / per_link), group % per_link };
+}
+
+void
+ChannelGroups::add(const ADCMatrix& matrix, size_t nsamples, size_t group, double* sum) const
+{
+  auto add_row = get_kernels().add_row;
+  int link = -1;
+  int slot = -1;
+  for (const auto& [member_link, ch] : m_members[group]) {
+    if (member_link != link) {
+      link = member_link;
+      slot = matrix.get_slot(link);
+      if (slot < 0) {
+        ers::error(InvalidInput(ERS_HERE, "Link " + std::to_string(link) + " was not present in data"));
+      }
+    }
+    if (slot >= 0) {
+      add_row(matrix.row(slot, ch), nsamples, sum);
+    }
+  }
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_CHANNELGROUPS_HPP_
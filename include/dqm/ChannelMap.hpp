@@ -40,7 +40,7 @@ public:
   template <class T>
   void fill(std::shared_ptr<daqdataformats::TriggerRecord> tr);
 
-  std::map<int, std::map<int, std::pair<int, int>>> get_map();
+  const std::map<int, std::map<int, std::pair<int, int>>>& get_map() const;
 };
 
 
@@ -51,8 +51,8 @@ ChannelMap::ChannelMap(std::string& name) {
   m_chmap_service = dunedaq::detchannelmaps::make_map(name);
 }
 
-std::map<int, std::map<int, std::pair<int, int>>>
-ChannelMap::get_map()
+const std::map<int, std::map<int, std::pair<int, int>>>&
+ChannelMap::get_map() const
 {
   return m_map;
 }
@@ -76,7 +76,7 @@ ChannelMap::fill(std::shared_ptr<daqdataformats::TriggerRecord> record)
   std::set<std::tuple<int, int, int>> frame_numbers;
   for (auto& [key, value] : frames) {
     // This is one link so we push back one element to m_map
-    for (auto& fr : value) {
+    for (auto fr : value) {
       int crate = get_crate<T>(fr);
       int slot = get_slot<T>(fr);
       int fiber = get_fiber<T>(fr);
@@ -9,6 +9,7 @@
 #define DQM_SRC_CHANNELSTREAM_HPP_
 
 // DQM
+#include "dqm/ADCMatrix.hpp"
 #include "dqm/AnalysisModule.hpp"
 #include "dqm/ChannelMap.hpp"
 #include "dqm/Constants.hpp"
@@ -19,27 +20,145 @@
 #include "dqm/DQMFormats.hpp"
 #include "dqm/DQMLogging.hpp"
 #include "dqm/FormatUtils.hpp"
+#include "dqm/LinkFrames.hpp"
+#include "dqm/WorkerPool.hpp"
 
 #include "daqdataformats/TriggerRecord.hpp"
 
+#include <algorithm>
 #include <functional>
+#include <cstdint>
 #include <cstdlib>
 #include <map>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace dunedaq::dqm {
 
-template<class T, class I>
+/**
+ * Storage with one object of type T per channel, for algorithms that can't
+ * be kept as a few numbers per channel (see ChannelStats for those)
+ */
+template<class T>
+class ChannelArray : public std::vector<T>
+{
+public:
+  explicit ChannelArray(size_t nchannels)
+    : std::vector<T>(nchannels)
+  {}
+
+  void fill(size_t ch, const uint16_t* adcs, size_t n) { (*this)[ch].fill(adcs, n); }
+
+  void clean()
+  {
+    for (auto& elem : *this) {
+      elem.clean();
+    }
+  }
+};
+
+/**
+ * Storages that count saturated values need the full scale of the ADC
+ */
+template<class C, class = void>
+struct has_full_scale : std::false_type
+{};
+
+template<class C>
+struct has_full_scale<C, std::void_t<decltype(std::declval<C&>().set_full_scale(uint16_t()))>> : std::true_type
+{};
+
+/**
+ * Storages that can combine partial results, needed for sliding windows
+ */
+template<class C, class = void>
+struct has_merge : std::false_type
+{};
+
+template<class C>
+struct has_merge<C, std::void_t<decltype(std::declval<C&>().merge(std::declval<const C&>()))>> : std::true_type
+{};
+
+/**
+ * Storages whose space depends on the number of samples, reserve_samples(n) is
+ * called before the channels of a record (with at most n samples) are filled
+ */
+template<class C, class = void>
+struct has_reserve_samples : std::false_type
+{};
+
+template<class C>
+struct has_reserve_samples<C, std::void_t<decltype(std::declval<C&>().reserve_samples(size_t()))>> : std::true_type
+{};
+
+/**
+ * Storages that can append the values of a channel to the message directly,
+ * used by the streams that have no function
+ */
+template<class C, class I, class = void>
+struct has_gather : std::false_type
+{};
+
+template<class C, class I>
+struct has_gather<C, I, std::void_t<decltype(std::declval<const C&>().gather(size_t(), std::declval<std::vector<I>&>()))>>
+  : std::true_type
+{};
+
+/**
+ * Storages that describe how the values were computed, get_header_fields()
+ * returns fields that are added to the header of every message
+ */
+template<class C, class = void>
+struct has_header_fields : std::false_type
+{};
+
+template<class C>
+struct has_header_fields<C, std::void_t<decltype(std::string(std::declval<const C&>().get_header_fields()))>>
+  : std::true_type
+{};
+
+/**
+ * Runs an algorithm on every channel and sends one value (or a vector of
+ * values) per channel. C is the storage for all the channels, it has to
+ * provide size(), fill(ch, adcs, n), clean() and C(nchannels) unless an
+ * already built storage is given
+ *
+ * Several streams can be sent from the same storage, each one with its own
+ * name and function, so that the data is only traversed once for all of them.
+ * A stream without function sends what the storage gathers for each channel
+ *
+ * By default every record is sent on its own. With set_window the data of
+ * several records is combined before sending, so that short (cheap) requests
+ * to readout still give statistically meaningful values
+ */
+template<class C, class I>
 class ChannelStream : public AnalysisModule
 {
 
 public:
+  using function_type = std::function<std::vector<I>(C&, int, int)>;
+
   ChannelStream(std::string name,
                 int nhist,
                 std::vector<int>& link_idx,
-                std::function<std::vector<I>(std::vector<T>&, int, int)> function);
+                function_type function);
+
+  ChannelStream(std::string name,
+                int nhist,
+                std::vector<int>& link_idx,
+                std::vector<std::pair<std::string, function_type>> streams);
+
+  /**
+   * @brief For storages that need more than the number of channels to be
+   *        built, storage is used as it is given
+   */
+  ChannelStream(std::string name,
+                std::vector<int>& link_idx,
+                C storage,
+                std::vector<std::pair<std::string, function_type>> streams);
 
   void run(std::shared_ptr<daqdataformats::TriggerRecord> record,
       DQMArgs& args, DQMInfo& info) override;
@@ -54,40 +173,78 @@ public:
                 int run_num);
 
   void clean();
-  void fill(int ch, int link, I value);
   int get_local_index(int ch, int link);
 
+  /**
+   * @brief Combine the data of several records in each message
+   * @param nrecords Number of records in the window, 1 or less sends every record on its own
+   * @param sliding If false, a message is sent every nrecords records and then the window
+   *        starts again. If true, a message is sent for every record with the last nrecords
+   *        records, this needs a storage with merge and otherwise it falls back to the former
+   */
+  void set_window(int nrecords, bool sliding);
+
 private:
+  void transmit_stream(const std::string& kafka_address,
+                       std::shared_ptr<ChannelMap>& cmap,
+                       const std::string& topicname,
+                       int run_num,
+                       const std::string& stream_name,
+                       function_type& function);
+
   std::string m_name;
-  std::vector<T> histvec;
+  C histvec;
   int m_size;
-  std::map<int, int> m_index;
+  LinkIndex m_index;
 
-  std::function<std::vector<I>(std::vector<T>&, int, int)> m_function;
+  // Name used as "algorithm" in the messages and function for each stream
+  std::vector<std::pair<std::string, function_type>> m_streams;
+
+  int m_window_records = 1;
+  bool m_sliding = false;
+  // Number of records in histvec since the last message (non sliding window)
+  int m_records_in_window = 0;
+  // One storage per record of the sliding window and the one to fill next
+  std::vector<C> m_window;
+  size_t m_next_record = 0;
+  // Values of the message being built, kept between messages
+  std::vector<I> m_values;
 };
 
-template <class T, class I>
-ChannelStream<T, I>::ChannelStream(std::string name,
+template <class C, class I>
+ChannelStream<C, I>::ChannelStream(std::string name,
             int nchannels,
             std::vector<int>& link_idx,
-            std::function<std::vector<I>(std::vector<T>&, int, int)> function)
+            function_type function)
+  : ChannelStream(name, nchannels, link_idx, {{name, function}})
+{
+}
+
+template <class C, class I>
+ChannelStream<C, I>::ChannelStream(std::string name,
+            int nchannels,
+            std::vector<int>& link_idx,
+            std::vector<std::pair<std::string, function_type>> streams)
+  : ChannelStream(name, link_idx, C(nchannels), std::move(streams))
+{
+}
+
+template <class C, class I>
+ChannelStream<C, I>::ChannelStream(std::string name,
+            std::vector<int>& link_idx,
+            C storage,
+            std::vector<std::pair<std::string, function_type>> streams)
   : m_name(name)
-  , m_size(nchannels)
-  , m_function(function)
+  , histvec(std::move(storage))
+  , m_size(histvec.size())
+  , m_index(link_idx)
+  , m_streams(std::move(streams))
 {
-  for (int i = 0; i < m_size; ++i) {
-    histvec.emplace_back(T());
-  }
-  int channels = 0;
-  for (size_t i = 0; i < link_idx.size(); ++i) {
-    m_index[link_idx[i]] = channels;
-    channels += CHANNELS_PER_LINK;
-  }
 }
 
-template <class T, class I>
+template <class C, class I>
 void
-ChannelStream<T, I>::run(std::shared_ptr<daqdataformats::TriggerRecord> record,
+ChannelStream<C, I>::run(std::shared_ptr<daqdataformats::TriggerRecord> record,
                    DQMArgs& args, DQMInfo& info)
 {
   TLOG(TLVL_WORK_STEPS) << "Running "<< m_name << " with frontend_type = " << args.frontend_type;
@@ -116,58 +273,104 @@ ChannelStream<T, I>::run(std::shared_ptr<daqdataformats::TriggerRecord> record,
   info.std_times_run++;
 }
 
-template <class T, class I>
+template <class C, class I>
 template <class R>
 void
-ChannelStream<T, I>::run_(std::shared_ptr<daqdataformats::TriggerRecord> record,
+ChannelStream<C, I>::run_(std::shared_ptr<daqdataformats::TriggerRecord> record,
                           DQMArgs& args, DQMInfo& /*info*/)
 {
   auto map = args.map;
 
-  auto frames = decode<R>(record, args.max_frames);
-  auto pipe = Pipeline<R>({"remove_empty", "check_empty", "check_timestamps_aligned"});
-  bool valid_data = pipe(frames);
-  if (!valid_data) {
+  auto matrix = args.matrix_cache->get<R>(record, args);
+  if (!matrix) {
     return;
   }
 
-  // Get all the keys
-  std::vector<int> keys;
-  for (auto& [key, value] : frames) {
-    keys.push_back(key);
+  // With a sliding window every record has its own storage and histvec is
+  // rebuilt from them before sending
+  C& target = m_sliding ? m_window[m_next_record] : histvec;
+  if (m_sliding) {
+    target.clean();
+  }
+
+  if constexpr (has_full_scale<C>::value) {
+    target.set_full_scale(get_adc_full_scale<R>());
   }
 
-  for (const auto& [key, vec] : frames) {
-    for (const auto& fr : vec) {
-      for (int ich = 0; ich < CHANNELS_PER_LINK; ++ich) {
-        fill(ich, key, get_adc<R>(fr, ich));
+  if constexpr (has_reserve_samples<C>::value) {
+    size_t nsamples = 0;
+    for (size_t slot = 0; slot < matrix->get_num_links(); ++slot) {
+      nsamples = std::max(nsamples, matrix->get_num_samples(slot));
+    }
+    target.reserve_samples(nsamples);
+  }
+
+  // Every link fills its own part of the storage so the links can go in parallel
+  args.workers->parallel_for(matrix->get_num_links(), [&](size_t slot) {
+    int link_slot = m_index.get_slot(matrix->get_link(slot));
+    if (link_slot < 0) {
+      return;
+    }
+    int offset = link_slot * CHANNELS_PER_LINK;
+    size_t nsamples = matrix->get_num_samples(slot);
+    for (int ich = 0; ich < CHANNELS_PER_LINK; ++ich) {
+      target.fill(ich + offset, matrix->row(slot, ich), nsamples);
+    }
+  });
+
+  if (m_sliding) {
+    if constexpr (has_merge<C>::value) {
+      histvec.clean();
+      for (auto& partial : m_window) {
+        histvec.merge(partial);
       }
+      m_next_record = (m_next_record + 1) % m_window.size();
     }
+  } else if (++m_records_in_window < m_window_records) {
+    TLOG_DEBUG(TLVL_WORK_STEPS) << m_name << ": " << m_records_in_window << " out of " << m_window_records
+                                << " records in the window";
+    return;
   }
 
   transmit(args.kafka_address,
            map,
            args.kafka_topic,
            record->get_header_ref().get_run_number());
-  clean();
+  if (!m_sliding) {
+    clean();
+  }
 }
 
-template <class T, class I>
+template <class C, class I>
 void
-ChannelStream<T, I>::transmit(const std::string& kafka_address,
+ChannelStream<C, I>::transmit(const std::string& kafka_address,
                     std::shared_ptr<ChannelMap>& cmap,
                     const std::string& topicname,
                     int run_num)
+{
+  for (auto& [stream_name, function] : m_streams) {
+    transmit_stream(kafka_address, cmap, topicname, run_num, stream_name, function);
+  }
+}
+
+template <class C, class I>
+void
+ChannelStream<C, I>::transmit_stream(const std::string& kafka_address,
+                    std::shared_ptr<ChannelMap>& cmap,
+                    const std::string& topicname,
+                    int run_num,
+                    const std::string& stream_name,
+                    function_type& function)
 {
   // Placeholders
-  std::string dataname = m_name;
+  std::string dataname = stream_name;
   std::string partition = getenv("DUNEDAQ_PARTITION");
   std::string app_name = getenv("DUNEDAQ_APPLICATION_NAME");
   std::string datasource = partition + "_" + app_name;
 
   // One message is sent for every plane
-  auto channel_order = cmap->get_map();
-  for (auto& [plane, map] : channel_order) {
+  const auto& channel_order = cmap->get_map();
+  for (const auto& [plane, map] : channel_order) {
     std::stringstream output;
     output << "{";
     output << "\"source\": \"" << datasource << "\",";
@@ -175,26 +378,39 @@ ChannelStream<T, I>::transmit(const std::string& kafka_address,
     output << "\"partition\": \"" << partition << "\",";
     output << "\"app_name\": \"" << app_name << "\",";
     output << "\"plane\": \"" << plane << "\",";
-    output << "\"algorithm\": \"" << m_name << "\"";
+    output << "\"algorithm\": \"" << stream_name << "\"";
+    if constexpr (has_header_fields<C>::value) {
+      std::string fields = histvec.get_header_fields();
+      if (!fields.empty()) {
+        output << "," << fields;
+      }
+    }
     output << "}\n\n\n";
     std::vector<int> channels;
+    m_values.clear();
     for (auto& [offch, pair] : map) {
+      int link = pair.first;
+      int ch = pair.second;
+      // There is no data for links that are not in link_idx
+      if (m_index.get_slot(link) < 0) {
+        continue;
+      }
       channels.push_back(offch);
+      if constexpr (has_gather<C, I>::value) {
+        if (!function) {
+          histvec.gather(get_local_index(ch, link), m_values);
+          continue;
+        }
+      }
+      auto values = function(histvec, ch, link);
+      m_values.insert(m_values.end(), values.begin(), values.end());
     }
     auto bytes = serialization::serialize(channels, serialization::kMsgPack);
     for (auto& b : bytes) {
       output << b;
     }
     output << "\n\n\n";
-    std::vector<I> values;
-    for (auto& [offch, pair] : map) {
-      int link = pair.first;
-      int ch = pair.second;
-      for (const auto& entry : m_function(histvec, ch, link)) {
-        values.push_back(entry);
-      }
-    }
-    bytes = serialization::serialize(values, serialization::kMsgPack);
+    bytes = serialization::serialize(m_values, serialization::kMsgPack);
     for (auto& b : bytes) {
       output << b;
     }
@@ -222,27 +438,39 @@ ChannelStream<T, I>::transmit(const std::string& kafka_address,
   }
 }
 
-template <class T, class I>
+template <class C, class I>
 void
-ChannelStream<T, I>::clean()
+ChannelStream<C, I>::clean()
 {
-  for (int ich = 0; ich < m_size; ++ich) {
-    histvec[ich].clean();
-  }
+  histvec.clean();
+  m_records_in_window = 0;
 }
 
-template <class T, class I>
+template <class C, class I>
 void
-ChannelStream<T, I>::fill(int ch, int link, I value)
+ChannelStream<C, I>::set_window(int nrecords, bool sliding)
 {
-  histvec[ch + m_index[link]].fill(value);
+  m_window_records = std::max(nrecords, 1);
+  m_sliding = sliding && m_window_records > 1 && has_merge<C>::value;
+  if (sliding && !m_sliding && m_window_records > 1) {
+    TLOG() << m_name << " can't use a sliding window, a message will be sent every " << m_window_records << " records";
+  }
+  m_window.clear();
+  if (m_sliding) {
+    m_window.assign(m_window_records, histvec);
+    for (auto& partial : m_window) {
+      partial.clean();
+    }
+  }
+  m_next_record = 0;
+  clean();
 }
 
-template <class T, class I>
+template <class C, class I>
 int
-ChannelStream<T, I>::get_local_index(int ch, int link)
+ChannelStream<C, I>::get_local_index(int ch, int link)
 {
-  return ch + m_index[link];
+  return ch + m_index.get_slot(link) * CHANNELS_PER_LINK;
 }
 
 } // namespace dunedaq::dqm
@@ -9,6 +9,7 @@
 #define DQM_INCLUDE_DQM_DQM_FORMATS_HPP_
 
 #include "dqm/ChannelMap.hpp"
+#include "dqm/LinkFrames.hpp"
 
 #include <memory>
 #include <map>
@@ -16,6 +17,9 @@
 
 namespace dunedaq::dqm {
 
+class ADCMatrixCache;
+class WorkerPool;
+
 struct DQMArgs {
   std::shared_ptr<std::atomic<bool>> run_mark;
   std::shared_ptr<ChannelMap> map;
@@ -23,6 +27,10 @@ struct DQMArgs {
   std::string kafka_address;
   std::string kafka_topic;
   int max_frames;
+  std::shared_ptr<ADCMatrixCache> matrix_cache;
+  // Links from link_idx, fragments from other links are not decoded
+  std::shared_ptr<const LinkIndex> link_index;
+  std::shared_ptr<WorkerPool> workers;
 };
 
 struct DQMInfo {
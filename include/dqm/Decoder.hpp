@@ -12,10 +12,11 @@
 #include "daqdataformats/TriggerRecord.hpp"
 
 #include "ers/Issue.hpp"
+#include "logging/Logging.hpp"
 #include "dqm/Issues.hpp"
 #include "dqm/DQMLogging.hpp"
+#include "dqm/LinkFrames.hpp"
 
-#include <map>
 #include <memory>
 #include <vector>
 #include <string>
@@ -25,12 +26,25 @@ namespace dqm {
 
 using logging::TLVL_WORK_STEPS;
 
+inline bool
+is_tpc_fragment(const daqdataformats::Fragment& fragment)
+{
+  return fragment.get_fragment_type() == daqdataformats::FragmentType::kProtoWIB ||
+         fragment.get_fragment_type() == daqdataformats::FragmentType::kWIB ||
+         fragment.get_fragment_type() == daqdataformats::FragmentType::kTDE_AMC;
+}
+
+/**
+ * @brief Get the frames of every link of a TriggerRecord
+ * @param max_frames Maximum number of frames per link, no limit if it is 0
+ * @param index Links that will be decoded, fragments from other links are skipped
+ */
 template<class T>
-std::map<int, std::vector<T*>>
-decode(std::shared_ptr<daqdataformats::TriggerRecord> record, int max_frames) {
+LinkFrames<T>
+decode(std::shared_ptr<daqdataformats::TriggerRecord> record, int max_frames, std::shared_ptr<const LinkIndex> index) {
   const std::vector<std::unique_ptr<daqdataformats::Fragment>>& fragments = record->get_fragments_ref();
 
-  std::map<int, std::vector<T*>> frames;
+  LinkFrames<T> frames(std::move(index));
 
   std::string types_str;
   std::string sizes_str;
@@ -42,33 +56,44 @@ decode(std::shared_ptr<daqdataformats::TriggerRecord> record, int max_frames) {
                               << types_str << "and sizes " << sizes_str;
 
   for (const auto& fragment : fragments) {
-    if (fragment->get_fragment_type() != daqdataformats::FragmentType::kProtoWIB &&
-        fragment->get_fragment_type() != daqdataformats::FragmentType::kWIB &&
-        fragment->get_fragment_type() != daqdataformats::FragmentType::kTDE_AMC) {
+    if (!is_tpc_fragment(*fragment)) {
       continue;
     }
     auto id = fragment->get_element_id();
     auto element_id = id.id;
     int num_chunks =
       (fragment->get_size() - sizeof(daqdataformats::FragmentHeader)) / sizeof(T);
-    TLOG() << "size is " << fragment->get_size();
-    TLOG() << "num_chunks = " << num_chunks;
-    std::vector<T*> tmp;
+    TLOG_DEBUG(TLVL_WORK_STEPS) << "size is " << fragment->get_size() << ", num_chunks = " << num_chunks;
     // Don't put a limit if max_frames = 0
     if (max_frames > 0) {
       num_chunks = std::min(max_frames, num_chunks);
     }
-    for (int i = 0; i < num_chunks; ++i) {
-      T* frame = reinterpret_cast<T*>( // NOLINT
-      static_cast<char*>(fragment->get_data()) + (i * sizeof(T)));
-      tmp.push_back(frame);
+    // The frames are contiguous in the fragment so there is no need to
+    // have a pointer for each one of them
+    T* first = reinterpret_cast<T*>(fragment->get_data()); // NOLINT
+    if (!frames.insert(element_id, FrameSpan<T>(first, num_chunks))) {
+      TLOG_DEBUG(TLVL_WORK_STEPS) << "Skipping fragment from link " << element_id << " that is not in link_idx";
     }
-    frames[element_id] = tmp;
   }
 
   return frames;
 }
 
+/**
+ * @brief Get the frames of every link of a TriggerRecord, including all the links that are present
+ */
+template<class T>
+LinkFrames<T>
+decode(std::shared_ptr<daqdataformats::TriggerRecord> record, int max_frames) {
+  std::vector<int> links;
+  for (const auto& fragment : record->get_fragments_ref()) {
+    if (is_tpc_fragment(*fragment)) {
+      links.push_back(fragment->get_element_id().id);
+    }
+  }
+  return decode<T>(std::move(record), max_frames, std::make_shared<const LinkIndex>(links));
+}
+
 } // namespace dqm
 } // namespace dunedaq
 
@@ -8,6 +8,8 @@
 #ifndef DQM_INCLUDE_DQM_FORMATUTILS_HPP_
 #define DQM_INCLUDE_DQM_FORMATUTILS_HPP_
 
+#include "dqm/algs/Unpack.hpp"
+
 #include "fddetdataformats/WIBFrame.hpp"
 #include "fddetdataformats/WIB2Frame.hpp"
 
@@ -63,6 +65,19 @@ inline uint64_t get_timestamp(const T* fr) {
   return fr->get_timestamp();
 }
 
+/**
+ * @brief Largest value that the ADC can give
+ */
+template <class T>
+inline uint16_t get_adc_full_scale() {
+  return (1 << 14) - 1;
+}
+
+template <>
+inline uint16_t get_adc_full_scale<fddetdataformats::WIBFrame>() {
+  return (1 << 12) - 1;
+}
+
 template <class T>
 inline uint16_t get_adc(const T* fr, const int ch) {
   return -1;
@@ -78,6 +93,22 @@ inline uint16_t get_adc(const fddetdataformats::WIB2Frame* fr, const int ch) {
   return fr->get_adc(ch);
 }
 
+/**
+ * @brief Unpack the ADC values of all the channels of a frame
+ * @param out Array with space for the 256 channels of the frame
+ */
+template <class T>
+inline void unpack_frame(const T* fr, uint16_t* out) {
+  for (int ich = 0; ich < 256; ++ich) {
+    out[ich] = get_adc<T>(fr, ich);
+  }
+}
+
+template <>
+inline void unpack_frame(const fddetdataformats::WIB2Frame* fr, uint16_t* out) {
+  unpack_wib2(fr->adc_words, out);
+}
+
 } // namespace dunedaq::dqm
 
 #endif // DQM_INCLUDE_DQM_FORMATUTILS_HPP_
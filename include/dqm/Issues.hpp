@@ -44,6 +44,12 @@ ERS_DECLARE_ISSUE(dqm, EmptyData, "Data is empty after removing empty fragments"
 
 ERS_DECLARE_ISSUE(dqm, TimestampsNotAligned, "Timestamps are not aligned, DQM will align them", ((std::string)empty))
 
+ERS_DECLARE_ISSUE(dqm,
+                  NoTimestampOverlap,
+                  "The links don't overlap in time, the latest first timestamp is " << start
+                  << " and the earliest last timestamp is " << end,
+                  ((uint64_t)start)((uint64_t)end))
+
 ERS_DECLARE_ISSUE(dqm, InvalidInput, "Invalid input: " << why, ((std::string)why))
 
 ERS_DECLARE_ISSUE(dqm, BadCrateSlotFiber,
@@ -0,0 +1,281 @@
+/**
+ * @file LinkFrames.hpp Dense, link-ordered containers for the frames of a TriggerRecord
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_LINKFRAMES_HPP_
+#define DQM_INCLUDE_DQM_LINKFRAMES_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * Maps the element id of each link to a slot 0, 1, ..., N-1 following the order
+ * in which the links are given. It is built once (from link_idx at configure time)
+ * and then every lookup is an index into a table
+ */
+class LinkIndex
+{
+public:
+  LinkIndex() = default;
+  explicit LinkIndex(std::vector<int> links);
+
+  size_t size() const { return m_links.size(); }
+  int get_link(size_t slot) const { return m_links[slot]; }
+  const std::vector<int>& get_links() const { return m_links; }
+
+  /**
+   * @brief Slot of a link or -1 if the link is not known
+   */
+  int get_slot(int link) const;
+
+private:
+  // Ids larger than this go to a hash map instead of the table
+  static constexpr int s_max_table_size = 1 << 16;
+
+  std::vector<int> m_links;
+  std::vector<int> m_table;
+  std::unordered_map<int, int> m_large_ids;
+};
+
+LinkIndex::LinkIndex(std::vector<int> links)
+{
+  for (auto link : links) {
+    // Repeated links keep the first slot
+    if (get_slot(link) >= 0) {
+      continue;
+    }
+    int slot = m_links.size();
+    m_links.push_back(link);
+    if (link >= 0 && link < s_max_table_size) {
+      if (static_cast<size_t>(link) >= m_table.size()) {
+        m_table.resize(link + 1, -1);
+      }
+      m_table[link] = slot;
+    } else {
+      m_large_ids[link] = slot;
+    }
+  }
+}
+
+int
+LinkIndex::get_slot(int link) const
+{
+  if (link >= 0 && static_cast<size_t>(link) < m_table.size()) {
+    return m_table[link];
+  }
+  if (m_large_ids.empty()) {
+    return -1;
+  }
+  auto it = m_large_ids.find(link);
+  return it == m_large_ids.end() ? -1 : it->second;
+}
+
+/**
+ * Non-owning view of the frames of one link. The frames of a fragment are
+ * contiguous so only the first one and the number of frames are stored.
+ * Iterating gives pointers to the frames
+ */
+template<class T>
+class FrameSpan
+{
+public:
+  class iterator
+  {
+  public:
+    explicit iterator(T* frame)
+      : m_frame(frame)
+    {}
+    T* operator*() const { return m_frame; }
+    iterator& operator++()
+    {
+      ++m_frame;
+      return *this;
+    }
+    bool operator==(const iterator& other) const { return m_frame == other.m_frame; }
+    bool operator!=(const iterator& other) const { return m_frame != other.m_frame; }
+
+  private:
+    T* m_frame;
+  };
+
+  FrameSpan() = default;
+  FrameSpan(T* first, size_t size)
+    : m_first(first)
+    , m_size(size)
+  {}
+
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  T* operator[](size_t i) const { return m_first + i; }
+  T* front() const { return m_first; }
+  T* back() const { return m_first + m_size - 1; }
+  iterator begin() const { return iterator(m_first); }
+  iterator end() const { return iterator(m_first + m_size); }
+
+  /**
+   * @brief Keep only the frames [offset, offset + count)
+   */
+  FrameSpan subspan(size_t offset, size_t count) const { return FrameSpan(m_first + offset, count); }
+  void resize(size_t size) { m_size = std::min(size, m_size); }
+
+private:
+  T* m_first = nullptr;
+  size_t m_size = 0;
+};
+
+/**
+ * Frames of a TriggerRecord for each link, ordered by link. The interface
+ * resembles the one of std::map<int, FrameSpan<T>> but the links are stored
+ * contiguously and finding a link is a lookup in the LinkIndex
+ */
+template<class T>
+class LinkFrames
+{
+public:
+  using key_type = int;
+  using mapped_type = FrameSpan<T>;
+  using value_type = std::pair<int, FrameSpan<T>>;
+  using iterator = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  LinkFrames()
+    : LinkFrames(std::make_shared<const LinkIndex>())
+  {}
+  explicit LinkFrames(std::shared_ptr<const LinkIndex> index)
+    : m_index(std::move(index))
+    , m_position(m_index->size(), -1)
+  {
+    m_links.reserve(m_index->size());
+  }
+
+  /**
+   * @brief Add the frames of a link, returns false if the link is not in the index
+   */
+  bool insert(int link, FrameSpan<T> frames);
+
+  iterator erase(iterator it);
+
+  /**
+   * @brief Remove the links for which pred(value) is true in a single pass
+   */
+  template<class Pred>
+  void remove_if(Pred pred);
+
+  iterator find(int link);
+  const_iterator find(int link) const;
+
+  /**
+   * @brief Frames for a link that has to be present
+   */
+  FrameSpan<T>& at(int link) { return m_links[m_position[m_index->get_slot(link)]].second; }
+  const FrameSpan<T>& at(int link) const { return m_links[m_position[m_index->get_slot(link)]].second; }
+
+  size_t size() const { return m_links.size(); }
+  bool empty() const { return m_links.empty(); }
+  iterator begin() { return m_links.begin(); }
+  iterator end() { return m_links.end(); }
+  const_iterator begin() const { return m_links.begin(); }
+  const_iterator end() const { return m_links.end(); }
+
+  const std::shared_ptr<const LinkIndex>& get_index() const { return m_index; }
+
+private:
+  void update_positions();
+
+  std::shared_ptr<const LinkIndex> m_index;
+  std::vector<value_type> m_links;
+  // Position in m_links of each slot of the index, -1 if the link is not present
+  std::vector<int> m_position;
+};
+
+template<class T>
+bool
+LinkFrames<T>::insert(int link, FrameSpan<T> frames)
+{
+  int slot = m_index->get_slot(link);
+  if (slot < 0) {
+    return false;
+  }
+  if (m_position[slot] >= 0) {
+    m_links[m_position[slot]].second = frames;
+    return true;
+  }
+  // Fragments usually come ordered by link so this is normally a push_back
+  auto it = std::upper_bound(m_links.begin(), m_links.end(), link,
+                             [](int l, const value_type& value) { return l < value.first; });
+  bool at_end = it == m_links.end();
+  m_links.insert(it, { link, frames });
+  if (at_end) {
+    m_position[slot] = m_links.size() - 1;
+  } else {
+    update_positions();
+  }
+  return true;
+}
+
+template<class T>
+typename LinkFrames<T>::iterator
+LinkFrames<T>::erase(iterator it)
+{
+  auto pos = it - m_links.begin();
+  m_links.erase(it);
+  update_positions();
+  return m_links.begin() + pos;
+}
+
+template<class T>
+template<class Pred>
+void
+LinkFrames<T>::remove_if(Pred pred)
+{
+  auto it = std::remove_if(m_links.begin(), m_links.end(), pred);
+  if (it != m_links.end()) {
+    m_links.erase(it, m_links.end());
+    update_positions();
+  }
+}
+
+template<class T>
+typename LinkFrames<T>::iterator
+LinkFrames<T>::find(int link)
+{
+  int slot = m_index->get_slot(link);
+  if (slot < 0 || m_position[slot] < 0) {
+    return m_links.end();
+  }
+  return m_links.begin() + m_position[slot];
+}
+
+template<class T>
+typename LinkFrames<T>::const_iterator
+LinkFrames<T>::find(int link) const
+{
+  int slot = m_index->get_slot(link);
+  if (slot < 0 || m_position[slot] < 0) {
+    return m_links.end();
+  }
+  return m_links.begin() + m_position[slot];
+}
+
+template<class T>
+void
+LinkFrames<T>::update_positions()
+{
+  std::fill(m_position.begin(), m_position.end(), -1);
+  for (size_t i = 0; i < m_links.size(); ++i) {
+    m_position[m_index->get_slot(m_links[i].first)] = i;
+  }
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_LINKFRAMES_HPP_
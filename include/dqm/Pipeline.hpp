@@ -1,5 +1,5 @@
 /**
- * @file Decoder.hpp Implementation of decoders used in DQM analysis modules
+ * @file Pipeline.hpp Checks and transformations of the decoded frames before running the algorithms
  *
  * This is part of the DUNE DAQ , copyright 2020.
  * Licensing/copyright details are in the COPYING file that you should have
@@ -10,130 +10,311 @@
 
 #include "DQMLogging.hpp"
 #include "ers/Issue.hpp"
+#include "logging/Logging.hpp"
 #include "dqm/Issues.hpp"
 #include "dqm/DQMLogging.hpp"
 #include "dqm/DQMFormats.hpp"
+#include "dqm/FormatUtils.hpp"
+#include "dqm/LinkFrames.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
-#include <map>
-#include <vector>
-#include <functional>
+#include <limits>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
 
 namespace dunedaq {
 namespace dqm {
 
 using logging::TLVL_WORK_STEPS;
 
+/**
+ * Every stage has two parts so that all of them can share a single traversal
+ * of the links:
+ *   keep(value) is called once for each link and returns false to drop the link
+ *   finish(frames) is called after the traversal and returns false if the data is not valid
+ */
+
 template<class T>
-int
-remove_empty(std::map<int, std::vector<T*>>& map)
+struct RemoveEmpty
 {
-  TLOG(TLVL_WORK_STEPS) << "Removing empty fragments";
   bool empty_fragments = false;
-  for (auto& [key, val] : map)
-    if (not val.size() || val.size() == sizeof(daqdataformats::FragmentHeader)) {
+
+  bool keep(const std::pair<int, FrameSpan<T>>& value)
+  {
+    if (value.second.empty()) {
       empty_fragments = true;
-      map.erase(key);
+      return false;
     }
-  if (empty_fragments) {
-    ers::warning(EmptyFragments(ERS_HERE, ""));
+    return true;
   }
-  return true;
-}
+  bool finish(LinkFrames<T>& /*frames*/)
+  {
+    if (empty_fragments) {
+      ers::warning(EmptyFragments(ERS_HERE, ""));
+    }
+    return true;
+  }
+};
 
 template<class T>
-int
-check_empty(std::map<int, std::vector<T*>>& map)
+struct CheckEmpty
 {
-  TLOG(TLVL_WORK_STEPS) << "Checking if the data is empty";
-  if (not map.size()) {
-    ers::error(EmptyData(ERS_HERE, ""));
-    return false;
+  bool keep(const std::pair<int, FrameSpan<T>>& /*value*/) { return true; }
+  bool finish(LinkFrames<T>& frames)
+  {
+    if (frames.empty()) {
+      ers::error(EmptyData(ERS_HERE, ""));
+      return false;
+    }
+    return true;
   }
-  return true;
-}
+};
 
 template<class T>
-int
-make_same_size(std::map<int, std::vector<T*>>& map)
+struct MakeSameSize
 {
-  TLOG(TLVL_WORK_STEPS) << "Making the fragments have the same size";
-  std::vector<size_t> sizes;
-  std::map<size_t, int> occurrences;
-  for (const auto& [key, val] : map) {
-    occurrences[val.size()]++;
-  }
-  if (occurrences.size() == 1) {
+  size_t min_size = std::numeric_limits<size_t>::max();
+  size_t max_size = 0;
+
+  bool keep(const std::pair<int, FrameSpan<T>>& value)
+  {
+    min_size = std::min(min_size, value.second.size());
+    max_size = std::max(max_size, value.second.size());
     return true;
   }
-  auto min_size = (*occurrences.begin()).first;
-  for (auto& [key, vec] : map) {
-    vec.resize(min_size);
+  bool finish(LinkFrames<T>& frames)
+  {
+    // Only when the sizes differ a second pass is needed
+    if (min_size != max_size) {
+      for (auto& [key, val] : frames) {
+        val.resize(min_size);
+      }
+    }
+    return true;
   }
-
-  return true;
-}
+};
 
 template<class T>
-int
-check_timestamps_aligned(std::map<int, std::vector<T*>>& map)
+struct CheckTimestampsAligned
 {
-  TLOG(TLVL_WORK_STEPS) << "Checking that the timestamps are aligned";
-  uint64_t timestamp = get_timestamp<T>((*map.begin()).second[0]);
+  bool first = true;
+  uint64_t timestamp = 0;
   bool different_timestamp = false;
-  for (const auto& [key, val] : map) {
-    if (get_timestamp<T>(*val.begin()) != timestamp) {
+
+  bool keep(const std::pair<int, FrameSpan<T>>& value)
+  {
+    if (value.second.empty() || different_timestamp) {
+      return true;
+    }
+    if (first) {
+      timestamp = get_timestamp<T>(value.second.front());
+      first = false;
+    } else if (get_timestamp<T>(value.second.front()) != timestamp) {
       different_timestamp = true;
-      break;
     }
+    return true;
+  }
+  bool finish(LinkFrames<T>& /*frames*/)
+  {
+    if (different_timestamp) {
+      ers::warning(TimestampsNotAligned(ERS_HERE, ""));
+    }
+    return true;
+  }
+};
+
+/**
+ * Slices every link to the time window that all the links have in common so
+ * that the same sample index corresponds to the same time in every link.
+ * Frames are assumed to be ordered by timestamp and to share the same period.
+ * Only the spans change, no frame is copied
+ */
+template<class T>
+struct AlignTimestamps
+{
+  uint64_t start = 0;
+  uint64_t end = std::numeric_limits<uint64_t>::max();
+
+  bool keep(const std::pair<int, FrameSpan<T>>& value)
+  {
+    if (!value.second.empty()) {
+      start = std::max(start, get_timestamp<T>(value.second.front()));
+      end = std::min(end, get_timestamp<T>(value.second.back()));
+    }
+    return true;
+  }
+  bool finish(LinkFrames<T>& frames)
+  {
+    if (frames.empty()) {
+      return true;
+    }
+    if (start > end) {
+      ers::error(NoTimestampOverlap(ERS_HERE, start, end));
+      return false;
+    }
+    size_t common_size = std::numeric_limits<size_t>::max();
+    std::vector<size_t> offsets;
+    offsets.reserve(frames.size());
+    for (const auto& [key, val] : frames) {
+      size_t first = lower_bound(val, start);
+      size_t last = lower_bound(val, end + 1);
+      offsets.push_back(first);
+      common_size = std::min(common_size, last - first);
+    }
+    // The windows overlap but some link has no frame inside, for example
+    // because of a gap in its frames
+    if (common_size == 0) {
+      ers::error(NoTimestampOverlap(ERS_HERE, start, end));
+      return false;
+    }
+    size_t i = 0;
+    for (auto& [key, val] : frames) {
+      if (offsets[i] != 0 || val.size() != common_size) {
+        TLOG_DEBUG(TLVL_WORK_STEPS) << "Link " << key << " aligned to frames [" << offsets[i] << ", "
+                                    << offsets[i] + common_size << ") out of " << val.size();
+      }
+      val = val.subspan(offsets[i], common_size);
+      ++i;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Index of the first frame with a timestamp not lower than timestamp
+   */
+  static size_t lower_bound(const FrameSpan<T>& span, uint64_t timestamp)
+  {
+    size_t lo = 0, hi = span.size();
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (get_timestamp<T>(span[mid]) < timestamp) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
   }
-  if (different_timestamp) {
-    ers::warning(TimestampsNotAligned(ERS_HERE, ""));
+};
+
+/**
+ * Pipeline whose stages are known at compile time, for example
+ * StaticPipeline<T, RemoveEmpty, CheckEmpty>. The links are traversed only
+ * once and nothing is allocated
+ */
+template<class T, template<class> class... Stages>
+class StaticPipeline
+{
+public:
+  bool operator()(LinkFrames<T>& frames) const
+  {
+    TLOG(TLVL_WORK_STEPS) << "Running " << sizeof...(Stages) << " checks on the fragments";
+    std::tuple<Stages<T>...> stages;
+    frames.remove_if([&stages](const std::pair<int, FrameSpan<T>>& value) {
+      return !std::apply([&value](auto&... stage) { return (stage.keep(value) && ...); }, stages);
+    });
+    // The stages finish in order and the first one that fails stops the rest
+    return std::apply([&frames](auto&... stage) { return (stage.finish(frames) && ...); }, stages);
   }
-  return true;
+};
+
+template<class T>
+int
+remove_empty(LinkFrames<T>& frames)
+{
+  return StaticPipeline<T, RemoveEmpty>()(frames);
 }
 
+template<class T>
+int
+check_empty(LinkFrames<T>& frames)
+{
+  return StaticPipeline<T, CheckEmpty>()(frames);
+}
 
+template<class T>
+int
+make_same_size(LinkFrames<T>& frames)
+{
+  return StaticPipeline<T, MakeSameSize>()(frames);
+}
+
+template<class T>
+int
+check_timestamps_aligned(LinkFrames<T>& frames)
+{
+  return StaticPipeline<T, CheckTimestampsAligned>()(frames);
+}
+
+template<class T>
+int
+align_timestamps(LinkFrames<T>& frames)
+{
+  return StaticPipeline<T, AlignTimestamps>()(frames);
+}
+
+/**
+ * Pipeline built from the names of the stages, for when they are only known
+ * at runtime. The names are resolved once in the constructor and running it
+ * is a single traversal like StaticPipeline
+ */
 template<class T>
 class Pipeline
 {
-  std::vector<std::function<int(std::map<int, std::vector<T*>>& arg)>> m_functions;
-  std::vector<std::string> m_function_names;
-
-  std::map<std::string, std::function<int(std::map<int, std::vector<T*>>& arg)>>
-  m_available_functions { {"remove_empty", remove_empty<T>},
-                          {"check_empty", check_empty<T>},
-                          {"make_same_size", make_same_size<T>},
-                          {"check_timestamps_aligned", check_timestamps_aligned<T>},
+  using Stage =
+    std::variant<RemoveEmpty<T>, CheckEmpty<T>, MakeSameSize<T>, CheckTimestampsAligned<T>, AlignTimestamps<T>>;
+  static constexpr size_t s_num_available = std::variant_size_v<Stage>;
+  static constexpr std::array<const char*, s_num_available> s_names {
+    "remove_empty", "check_empty", "make_same_size", "check_timestamps_aligned", "align_timestamps"
   };
 
-public:
-  Pipeline(std::vector<std::string>& names)
+  // Index in Stage of each stage that will run, in order
+  std::array<size_t, s_num_available> m_stages {};
+  size_t m_num_stages = 0;
+
+  template<size_t... Is>
+  static Stage make_stage(size_t index, std::index_sequence<Is...>)
   {
-    for (auto& name: names) {
-      if (m_available_functions.find(name) != m_available_functions.end()) {
-        m_function_names.push_back(name);
-        m_functions.push_back(m_available_functions[name]);
-      }
-    }
+    Stage stage;
+    ((index == Is ? (void)stage.template emplace<Is>() : (void)0), ...);
+    return stage;
   }
-  Pipeline(std::vector<std::string>&& names) {
-    for (auto& name: names) {
-      if (m_available_functions.find(name) != m_available_functions.end()) {
-        m_function_names.push_back(name);
-        m_functions.push_back(m_available_functions[name]);
+
+public:
+  Pipeline(const std::vector<std::string>& names)
+  {
+    for (auto& name : names) {
+      for (size_t i = 0; i < s_num_available; ++i) {
+        bool already_added = std::find(m_stages.begin(), m_stages.begin() + m_num_stages, i) != m_stages.begin() + m_num_stages;
+        if (name == s_names[i] && !already_added) {
+          m_stages[m_num_stages++] = i;
+        }
       }
     }
-
   }
 
-  bool operator() (std::map<int, std::vector<T*>>& arg) {
-    for (size_t i = 0; i < m_functions.size(); ++i) {
-      auto fun = m_functions[i];
-      auto name = m_function_names[i];
-      int ret = fun(arg);
-      if (!ret) {
+  bool operator() (LinkFrames<T>& frames) const
+  {
+    TLOG(TLVL_WORK_STEPS) << "Running " << m_num_stages << " checks on the fragments";
+    std::array<Stage, s_num_available> stages;
+    for (size_t i = 0; i < m_num_stages; ++i) {
+      stages[i] = make_stage(m_stages[i], std::make_index_sequence<s_num_available>());
+    }
+    frames.remove_if([&](const std::pair<int, FrameSpan<T>>& value) {
+      for (size_t i = 0; i < m_num_stages; ++i) {
+        if (!std::visit([&value](auto& stage) { return stage.keep(value); }, stages[i])) {
+          return true;
+        }
+      }
+      return false;
+    });
+    for (size_t i = 0; i < m_num_stages; ++i) {
+      if (!std::visit([&frames](auto& stage) { return stage.finish(frames); }, stages[i])) {
         return false;
       }
     }
@@ -0,0 +1,46 @@
+/**
+ * @file Span.hpp Non-owning view of contiguous values
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_SPAN_HPP_
+#define DQM_INCLUDE_DQM_SPAN_HPP_
+
+#include <cstddef>
+
+namespace dunedaq::dqm {
+
+/**
+ * Pointer and size of values owned by someone else, like a minimal
+ * std::span. It is only valid while the owner doesn't reallocate them
+ */
+template<class T>
+class Span
+{
+public:
+  using value_type = T;
+  using iterator = T*;
+
+  Span() = default;
+  Span(T* data, size_t size)
+    : m_data(data)
+    , m_size(size)
+  {}
+
+  T* data() const { return m_data; }
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+  T& operator[](size_t i) const { return m_data[i]; }
+  iterator begin() const { return m_data; }
+  iterator end() const { return m_data + m_size; }
+
+private:
+  T* m_data = nullptr;
+  size_t m_size = 0;
+};
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_SPAN_HPP_
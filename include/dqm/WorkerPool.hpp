@@ -0,0 +1,165 @@
+/**
+ * @file WorkerPool.hpp Pool of threads that process the links of a TriggerRecord in parallel
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_WORKERPOOL_HPP_
+#define DQM_INCLUDE_DQM_WORKERPOOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * Fixed number of threads shared by all the modules. parallel_for can be
+ * called at the same time from different threads (each module runs in its
+ * own thread) and the calling thread also takes part in the work
+ */
+class WorkerPool
+{
+public:
+  /**
+   * @param nthreads Total number of threads working on each call including the
+   *        calling thread, with 1 or less everything runs in the calling thread
+   */
+  explicit WorkerPool(int nthreads);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  int get_num_threads() const { return m_threads.size() + 1; }
+
+  /**
+   * @brief Call function(i) for i in [0, n) and return when all the calls have finished
+   *
+   *        The calls for different i have to write to different places.
+   *        If some call throws, the first exception is rethrown here
+   */
+  void parallel_for(size_t n, const std::function<void(size_t)>& function);
+
+private:
+  struct Batch
+  {
+    const std::function<void(size_t)>* function;
+    size_t size;
+    std::atomic<size_t> next{ 0 };
+    std::atomic<size_t> done{ 0 };
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr exception;
+  };
+
+  void work();
+  void run_batch(Batch& batch);
+
+  std::vector<std::thread> m_threads;
+  std::deque<std::shared_ptr<Batch>> m_queue;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_stop = false;
+};
+
+WorkerPool::WorkerPool(int nthreads)
+{
+  for (int i = 1; i < nthreads; ++i) {
+    m_threads.emplace_back(&WorkerPool::work, this);
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+void
+WorkerPool::parallel_for(size_t n, const std::function<void(size_t)>& function)
+{
+  if (m_threads.empty() || n <= 1) {
+    for (size_t i = 0; i < n; ++i) {
+      function(i);
+    }
+    return;
+  }
+
+  auto batch = std::make_shared<Batch>();
+  batch->function = &function;
+  batch->size = n;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.push_back(batch);
+  }
+  m_cv.notify_all();
+
+  run_batch(*batch);
+
+  std::unique_lock<std::mutex> lock(batch->mutex);
+  batch->finished.wait(lock, [&] { return batch->done.load() == n; });
+  if (batch->exception) {
+    std::rethrow_exception(batch->exception);
+  }
+}
+
+void
+WorkerPool::run_batch(Batch& batch)
+{
+  size_t i;
+  while ((i = batch.next++) < batch.size) {
+    try {
+      (*batch.function)(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(batch.mutex);
+      if (!batch.exception) {
+        batch.exception = std::current_exception();
+      }
+    }
+    if (++batch.done == batch.size) {
+      std::lock_guard<std::mutex> lock(batch.mutex);
+      batch.finished.notify_all();
+    }
+  }
+}
+
+void
+WorkerPool::work()
+{
+  while (true) {
+    std::shared_ptr<Batch> batch;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+      if (m_stop) {
+        return;
+      }
+      batch = m_queue.front();
+      // Once every index has been taken the batch doesn't need more threads
+      if (batch->next.load() >= batch->size) {
+        m_queue.pop_front();
+        continue;
+      }
+    }
+    run_batch(*batch);
+  }
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_WORKERPOOL_HPP_
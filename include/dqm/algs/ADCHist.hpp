@@ -0,0 +1,112 @@
+/**
+ * @file ADCHist.hpp Histograms of the ADC values of many channels with one bin for every value
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALGS_ADCHIST_HPP_
+#define DQM_INCLUDE_DQM_ALGS_ADCHIST_HPP_
+
+#include "dqm/AlignedAllocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * Histogram of the ADC values of every channel with one bin for each value
+ * in [low, low + nbins), so finding the bin is a subtraction. The counts of
+ * all the channels are in a single [channel][bin] matrix and values outside
+ * of the range go to the underflow and overflow of the channel. The first
+ * and last bins with entries of each channel are kept so that the results
+ * only go through the bins that are used.
+ *
+ * C is the type of the counts, uint16_t takes half the memory of uint32_t
+ * and its counts saturate at 65535 instead of wrapping around
+ */
+template<class C = uint32_t>
+class ADCHist
+{
+public:
+  /**
+   * @param nbins Number of bins, 1 << 14 covers every value of a 14 bit ADC
+   *        and 1 << 12 of a 12 bit ADC
+   * @param low Value of the first bin
+   */
+  explicit ADCHist(size_t nchannels = 0, int nbins = 1 << 14, int low = 0);
+
+  size_t size() const { return m_underflow.size(); }
+  int get_num_bins() const { return m_nbins; }
+  int get_low() const { return m_low; }
+
+  /**
+   * @brief Add n ADC values of channel ch at once
+   */
+  void fill(size_t ch, const uint16_t* adcs, size_t n);
+
+  /**
+   * @brief Add the entries of other, that has to have the same channels and bins
+   */
+  void merge(const ADCHist& other);
+
+  void clean();
+
+  /**
+   * @brief get_num_bins() counts of channel ch, bin b is the value get_low() + b
+   */
+  const C* get_bins(size_t ch) const { return m_bins.data() + ch * m_stride; }
+  uint64_t get_underflow(size_t ch) const { return m_underflow[ch]; }
+  uint64_t get_overflow(size_t ch) const { return m_overflow[ch]; }
+
+  /**
+   * @brief Number of entries inside the range of the bins
+   */
+  uint64_t get_entries(size_t ch) const;
+
+  /**
+   * @brief Moments of the entries inside the range of the bins, -1 when
+   *        there are not enough entries
+   */
+  double mean(size_t ch) const;
+  double std(size_t ch) const;
+
+  /**
+   * @brief Value below which there is a fraction q of the entries inside the
+   *        range, -1 if there are none. The entries of a bin are taken as
+   *        spread uniformly over [value - 0.5, value + 0.5)
+   */
+  double quantile(size_t ch, double q) const;
+
+  /**
+   * @brief Standard deviation of the entries with values in [low, high], -1
+   *        when there are not enough entries
+   */
+  double truncated_std(size_t ch, double low, double high) const;
+
+  // Number of histograms that are filled in turns before being added
+  static constexpr size_t s_num_sub = 4;
+
+private:
+  C* row(size_t ch) { return m_bins.data() + ch * m_stride; }
+
+  int m_nbins;
+  int m_low;
+  // Rows padded to whole cache lines
+  size_t m_stride;
+  aligned_vector<C> m_bins;
+  std::vector<uint64_t> m_underflow;
+  std::vector<uint64_t> m_overflow;
+  // First and last bin with entries, m_nbins and -1 when there are none
+  std::vector<int> m_first_bin;
+  std::vector<int> m_last_bin;
+};
+
+extern template class ADCHist<uint16_t>;
+extern template class ADCHist<uint32_t>;
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_ALGS_ADCHIST_HPP_
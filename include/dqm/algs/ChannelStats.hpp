@@ -0,0 +1,64 @@
+/**
+ * @file ChannelStats.hpp Moments of the ADC distribution of many channels stored as separate arrays
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALGS_CHANNELSTATS_HPP_
+#define DQM_INCLUDE_DQM_ALGS_CHANNELSTATS_HPP_
+
+#include "dqm/AlignedAllocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dunedaq {
+namespace dqm {
+
+/**
+ * Number of entries, sum and sum of squares for every channel, each one in its
+ * own contiguous array instead of one object per channel. ADC values are
+ * integers so the sums are exact
+ */
+class ChannelStats
+{
+
+public:
+  explicit ChannelStats(size_t nchannels = 0);
+
+  size_t size() const { return m_counts.size(); }
+
+  /**
+   * @brief Add n ADC values of channel ch at once
+   */
+  void fill(size_t ch, const uint16_t* adcs, size_t n);
+
+  /**
+   * @brief Add the entries of other, that has to have the same number of channels
+   */
+  void merge(const ChannelStats& other);
+
+  void clean();
+
+  uint64_t get_count(size_t ch) const { return m_counts[ch]; }
+  uint64_t get_sum(size_t ch) const { return m_sums[ch]; }
+  uint64_t get_sum_sq(size_t ch) const { return m_sums_sq[ch]; }
+
+  /**
+   * @brief Results for channel ch, -1 when there are not enough entries
+   */
+  double mean(size_t ch) const;
+  double std(size_t ch) const;
+  double rms(size_t ch) const;
+
+protected:
+  aligned_vector<uint64_t> m_counts;
+  aligned_vector<uint64_t> m_sums;
+  aligned_vector<uint64_t> m_sums_sq;
+};
+
+} // namespace dunedaq
+} // namespace dqm
+
+#endif // DQM_INCLUDE_DQM_ALGS_CHANNELSTATS_HPP_
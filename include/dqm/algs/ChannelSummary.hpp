@@ -0,0 +1,64 @@
+/**
+ * @file ChannelSummary.hpp Moments, extremes and saturation of the ADC distribution of many channels
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALGS_CHANNELSUMMARY_HPP_
+#define DQM_INCLUDE_DQM_ALGS_CHANNELSUMMARY_HPP_
+
+#include "dqm/AlignedAllocator.hpp"
+#include "dqm/algs/ChannelStats.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dunedaq {
+namespace dqm {
+
+/**
+ * ChannelStats plus the minimum, the maximum and the number of values at 0
+ * and at full scale for every channel, all obtained in a single pass over the data
+ */
+class ChannelSummary : public ChannelStats
+{
+
+public:
+  explicit ChannelSummary(size_t nchannels = 0);
+
+  /**
+   * @brief Largest value of the ADC, values equal to it are counted as saturated
+   */
+  void set_full_scale(uint16_t full_scale) { m_full_scale = full_scale; }
+
+  void fill(size_t ch, const uint16_t* adcs, size_t n);
+
+  /**
+   * @brief Add the entries of other, that has to have the same number of channels
+   */
+  void merge(const ChannelSummary& other);
+
+  void clean();
+
+  /**
+   * @brief Results for channel ch, -1 when there are no entries
+   */
+  int min(size_t ch) const;
+  int max(size_t ch) const;
+
+  uint64_t get_zeros(size_t ch) const { return m_zeros[ch]; }
+  uint64_t get_saturated(size_t ch) const { return m_saturated[ch]; }
+
+private:
+  uint16_t m_full_scale = (1 << 14) - 1;
+  aligned_vector<uint16_t> m_mins;
+  aligned_vector<uint16_t> m_maxs;
+  aligned_vector<uint64_t> m_zeros;
+  aligned_vector<uint64_t> m_saturated;
+};
+
+} // namespace dunedaq
+} // namespace dqm
+
+#endif // DQM_INCLUDE_DQM_ALGS_CHANNELSUMMARY_HPP_
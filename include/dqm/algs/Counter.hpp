@@ -1,5 +1,5 @@
 /**
- * @file Counter.hpp Simple counter declaration
+ * @file Counter.hpp Raw ADC values of many channels in a single buffer
  *
  * This is part of the DUNE DAQ , copyright 2020.
  * Licensing/copyright details are in the COPYING file that you should have
@@ -8,30 +8,88 @@
 #ifndef DQM_INCLUDE_DQM_COUNTER_HPP_
 #define DQM_INCLUDE_DQM_COUNTER_HPP_
 
+#include "dqm/AlignedAllocator.hpp"
+#include "dqm/algs/RawReduction.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <vector>
 
-/**
- * Basic Counter implementation
- * Fill values and store them
- */
 namespace dunedaq {
 namespace dqm {
 
+/**
+ * Raw ADC values of every channel in a single [channel][sample] buffer. The
+ * space is allocated once for the number of samples that are expected and
+ * every fill is a block copy. reserve_samples makes space for more samples
+ * before the channels are filled (in parallel), growing the buffer if needed
+ *
+ * The samples can be reduced when they are gathered (see RawReduction). The
+ * size of the buckets comes from the channel with the most samples, so it is
+ * the same for every channel of a message
+ */
 class Counter
 {
 
 public:
-  std::vector<int> count;
-  int m_nentries = 0;
+  explicit Counter(size_t nchannels = 0, size_t nsamples = 0);
+
+  size_t size() const { return m_sizes.size(); }
 
   /**
-   * @brief Add an entry to the counts
-   * @param x The number that is being added
+   * @brief Number of samples of each channel that fit without growing
    */
-  void fill(const double x);
+  size_t get_capacity() const { return m_stride; }
+
+  /**
+   * @brief Make sure that every channel can take n more samples. It must not
+   *        be called at the same time as fill
+   */
+  void reserve_samples(size_t n);
+
+  /**
+   * @brief Add n ADC values of channel ch at once, the values that don't
+   *        fit after the last reserve_samples are dropped
+   */
+  void fill(size_t ch, const uint16_t* adcs, size_t n);
 
   void clean();
 
+  size_t get_num_samples(size_t ch) const { return m_sizes[ch]; }
+  const uint16_t* get_samples(size_t ch) const { return m_data.data() + ch * m_stride; }
+
+  /**
+   * @brief Reduce the samples of each channel to about points values (or
+   *        pairs of values) when they are gathered
+   */
+  void set_reduction(RawReduction reduction, size_t points);
+
+  RawReduction get_reduction() const { return m_reduction; }
+
+  /**
+   * @brief Number of samples in each bucket of the reduction, 1 without reduction
+   */
+  size_t get_bucket() const;
+
+  /**
+   * @brief Fields added to the header of the messages that describe the
+   *        reduction, empty without reduction
+   */
+  std::string get_header_fields() const;
+
+  /**
+   * @brief Append the (reduced) samples of channel ch to out
+   */
+  void gather(size_t ch, std::vector<uint32_t>& out) const;
+
+private:
+  // Samples per channel, rows padded to whole cache lines
+  size_t m_stride;
+  aligned_vector<uint16_t> m_data;
+  std::vector<size_t> m_sizes;
+  RawReduction m_reduction = RawReduction::kNone;
+  size_t m_points = 0;
 };
 
 } // namespace dunedaq
@@ -14,30 +14,96 @@
 // #include <complex> has to be before this include
 #include <fftw3.h>
 
+#include "dqm/AlignedAllocator.hpp"
 #include "dqm/Issues.hpp"
+#include "dqm/Span.hpp"
+#include "dqm/algs/FourierWindow.hpp"
 #include "logging/Logging.hpp"
 
 namespace dunedaq::dqm {
 
+/**
+ * Fourier transform of a single series. All the buffers are allocated in
+ * the constructor and keep their size, so the results are read through
+ * spans and references into them instead of copies
+ */
 class Fourier
 {
 public:
   double m_inc_size;
   int m_npoints;
-  std::vector<double> m_data;
+  // Aligned so that the shared plans of FourierPlans can be used on them
+  aligned_vector<double> m_data;
+  // Always npoints / 2 + 1 values, only meaningful when has_transform() is true
   std::vector<std::complex<double>> m_transform;
 
-  Fourier(double inc, int npoints);
+  /**
+   * @param npoints Number of points of the transform
+   * @param window Window applied to the samples
+   * @param nsamples Number of samples that are used, at most npoints, the
+   *        rest of the points are 0. With 0 it is npoints
+   */
+  Fourier(double inc, int npoints, FourierWindowType window = FourierWindowType::kNone, int nsamples = 0);
 
   void fill(double value);
-  void compute_fourier_transform();
-  std::vector<double> get_frequencies();
+
+  /**
+   * @brief Returns false if there are not enough samples or the plan couldn't be created.
+   *        The window is applied to m_data in place
+   */
+  bool compute_fourier_transform();
+
+  int get_num_samples() const { return m_nsamples; }
+
+  /**
+   * @brief Output frequencies (only non-negative frequencies), computed once
+   */
+  const std::vector<double>& get_frequencies() const { return m_frequencies; }
+
   void clean();
 
-  std::complex<double> get_transform_at(int index);
-  std::vector<std::complex<double>> get_transform();
+  bool has_transform() const { return m_has_transform; }
+
+  /**
+   * @brief Set m_transform to the sum of the transforms of others, that
+   *        have the same number of points
+   */
+  void set_sum(const std::vector<const Fourier*>& others);
+
+  std::complex<double> get_transform_at(int index) const;
+
+  /**
+   * @brief View of the transform, valid until the next
+   *        compute_fourier_transform or clean
+   */
+  Span<const std::complex<double>> get_transform() const { return { m_transform.data(), m_transform.size() }; }
+
+  /**
+   * @brief Write the absolute value of the transform to out, that has
+   *        space for get_frequencies().size() values
+   */
+  template<class R>
+  void get_magnitudes(R* out) const;
+
+private:
+  int m_nsamples;
+  // Empty when there is no window
+  std::vector<double> m_window;
+  // Output of fftw in half-complex format, kept between calls
+  aligned_vector<double> m_output;
+  std::vector<double> m_frequencies;
+  bool m_has_transform = false;
 };
 
+template<class R>
+void
+Fourier::get_magnitudes(R* out) const
+{
+  for (size_t i = 0; i < m_transform.size(); ++i) {
+    out[i] = std::abs(m_transform[i]);
+  }
+}
+
 
 } // namespace dunedaq::dqm
 
@@ -0,0 +1,83 @@
+/**
+ * @file FourierBands.hpp Compact representations of the spectra of every channel
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALGS_FOURIERBANDS_HPP_
+#define DQM_INCLUDE_DQM_ALGS_FOURIERBANDS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * Frequency bands in which the magnitudes of a transform are averaged, so
+ * that only a few values per channel have to be sent. The value of a band
+ * is the quadratic mean of the magnitudes of the frequencies inside it, so
+ * that it keeps the power of the band.
+ *
+ * A frequency f is in band b when edges[b] <= f < edges[b + 1], the last
+ * band also includes its upper edge. Bands without any frequency are merged
+ * with the next one (or the previous one for the last bands), so there may
+ * be fewer bands than requested
+ */
+class FourierBands
+{
+public:
+  FourierBands() = default;
+
+  /**
+   * @param frequencies Frequencies of the transform, in increasing order
+   * @param edges Edges of the bands in increasing order, at least two
+   */
+  FourierBands(const std::vector<double>& frequencies, std::vector<double> edges);
+
+  /**
+   * @brief nbands + 1 logarithmically spaced edges from the first non-zero
+   *        frequency to the last one, so the DC term is not in any band
+   */
+  static std::vector<double> log_edges(const std::vector<double>& frequencies, int nbands);
+
+  size_t size() const { return m_first.size(); }
+  bool empty() const { return m_first.empty(); }
+
+  /**
+   * @brief size() + 1 edges of the bands that are used
+   */
+  const std::vector<double>& get_edges() const { return m_edges; }
+
+  /**
+   * @brief Value of every band from the magnitudes of all the frequencies,
+   *        out has space for size() values
+   */
+  template<class R>
+  void reduce(const R* magnitudes, float* out) const;
+
+private:
+  // Frequencies [m_first[b], m_last[b]) are in band b
+  std::vector<size_t> m_first;
+  std::vector<size_t> m_last;
+  std::vector<double> m_edges;
+};
+
+/**
+ * @brief Convert to IEEE 754 half precision, rounding to nearest even. Values
+ *        larger than 65504 become infinity
+ */
+uint16_t float_to_half(float value);
+
+/**
+ * @brief Same as float_to_half but values beyond +-65504, the largest half
+ *        precision values, are sent as +-65504 instead of infinity
+ */
+uint16_t float_to_half_saturated(float value);
+
+float half_to_float(uint16_t value);
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_ALGS_FOURIERBANDS_HPP_
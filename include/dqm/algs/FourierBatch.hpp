@@ -0,0 +1,132 @@
+/**
+ * @file FourierBatch.hpp Fourier transforms of many channels at once using the fftw3 library
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALGS_FOURIERBATCH_HPP_
+#define DQM_INCLUDE_DQM_ALGS_FOURIERBATCH_HPP_
+
+#include "dqm/AlignedAllocator.hpp"
+#include "dqm/algs/FourierWindow.hpp"
+
+#include <complex>
+// #include <complex> has to be before this include
+#include <fftw3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * Absolute value of the fourier transform of every channel. The samples of
+ * all the channels are stored in a single [channel][sample] buffer and the
+ * channels are transformed in blocks with a single fftw plan for many
+ * transforms. The blocks are independent so they can be given to different
+ * threads. The magnitudes end up in a [channel][frequency] matrix
+ *
+ * R is the type used for the samples and the transforms, with float the
+ * single precision version of fftw is used. The ADC values have at most 14
+ * bits so float is enough for noise spectra and it moves half the memory
+ */
+template<class R = double>
+class FourierBatch
+{
+public:
+  /**
+   * @param inc Time between samples
+   * @param npoints Number of points of the transform of each channel
+   * @param window Window applied to the samples
+   * @param nsamples Number of samples used for each channel, at most npoints,
+   *        the rest of the points are 0. With 0 it is npoints
+   */
+  FourierBatch(size_t nchannels,
+               int npoints,
+               double inc,
+               FourierWindowType window = FourierWindowType::kNone,
+               int nsamples = 0);
+
+  size_t get_num_channels() const { return m_nchannels; }
+  int get_num_points() const { return m_npoints; }
+  int get_num_samples() const { return m_nsamples; }
+  size_t get_num_frequencies() const { return m_npoints / 2 + 1; }
+
+  /**
+   * @brief Input samples of channel ch, there is space for get_num_points() values
+   */
+  R* row(size_t ch) { return m_input.data() + ch * m_input_stride; }
+
+  /**
+   * @brief Copy the first get_num_samples() ADC values of channel ch
+   *        multiplied by the window
+   */
+  void fill(size_t ch, const uint16_t* adcs);
+
+  /**
+   * @brief Set all the samples of channel ch to 0
+   */
+  void clear(size_t ch);
+
+  size_t get_num_blocks() const { return (m_nchannels + s_channels_per_block - 1) / s_channels_per_block; }
+
+  /**
+   * @brief Transform the channels of one block, returns false if the plan couldn't be created
+   */
+  bool compute_block(size_t block);
+
+  /**
+   * @brief Transform every channel in the calling thread
+   */
+  bool compute();
+
+  /**
+   * @brief Magnitudes of channel ch for each of get_frequencies(), after compute
+   */
+  const R* get_magnitudes(size_t ch) const { return m_magnitudes.data() + ch * m_output_stride; }
+
+  /**
+   * @brief Output frequencies (only non-negative frequencies), computed once
+   */
+  const std::vector<double>& get_frequencies() const { return m_frequencies; }
+
+  // Number of channels transformed together by each plan execution
+  static constexpr size_t s_channels_per_block = 64;
+
+  /**
+   * @brief Create the plans that a batch of nchannels with npoints will use,
+   *        so that they can be saved as wisdom before any batch is built.
+   *        Returns false if any of them can't be created
+   */
+  static bool create_plans(size_t nchannels, int npoints);
+
+private:
+  // fftw_plan or fftwf_plan
+  using plan_type = std::conditional_t<std::is_same_v<R, float>, fftwf_plan, fftw_plan>;
+
+  static plan_type get_block_plan(int npoints, size_t nchannels);
+
+  size_t m_nchannels;
+  int m_npoints;
+  int m_nsamples;
+  double m_inc_size;
+  // Rows padded so that every one starts at a cache line and all of them
+  // have the same alignment that the plans were created with
+  size_t m_input_stride;
+  size_t m_output_stride;
+  aligned_vector<R> m_input;
+  aligned_vector<R> m_magnitudes;
+  // Empty when there is no window
+  aligned_vector<R> m_window;
+  std::vector<double> m_frequencies;
+};
+
+extern template class FourierBatch<double>;
+extern template class FourierBatch<float>;
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_ALGS_FOURIERBATCH_HPP_
@@ -0,0 +1,98 @@
+/**
+ * @file FourierPlans.hpp Cache of the fftw3 plans shared by all the Fourier objects
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALGS_FOURIERPLANS_HPP_
+#define DQM_INCLUDE_DQM_ALGS_FOURIERPLANS_HPP_
+
+#include <complex>
+// #include <complex> has to be before this include
+#include <fftw3.h>
+
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+
+namespace dunedaq::dqm {
+
+/**
+ * One real to half-complex plan for each number of points. The plans are
+ * created on buffers aligned like the ones of Fourier and are executed
+ * with the new-array interface (fftw_execute_r2r), which is thread safe,
+ * so a single plan serves every channel and every thread.
+ *
+ * Creating plans is not thread safe in fftw so every call to the planner
+ * goes through this class. Plans made with FFTW_MEASURE or FFTW_PATIENT are
+ * slow to create but can be saved as wisdom to a file and loaded on the
+ * next start
+ */
+class FourierPlans
+{
+public:
+  static FourierPlans& get();
+
+  FourierPlans(const FourierPlans&) = delete;
+  FourierPlans& operator=(const FourierPlans&) = delete;
+
+  /**
+   * @brief Planner flags for the plans created from now on: FFTW_ESTIMATE,
+   *        FFTW_MEASURE or FFTW_PATIENT. Existing plans are kept
+   */
+  void set_rigor(unsigned rigor);
+  unsigned get_rigor() const;
+
+  /**
+   * @brief Plan for npoints, it is created the first time, nullptr if it can't be created
+   */
+  fftw_plan get_plan(int npoints);
+
+  /**
+   * @brief Plan for howmany real to complex transforms of npoints each. The
+   *        input rows are input_distance doubles apart and the output rows
+   *        output_distance complex numbers apart, both have to keep the rows
+   *        aligned. nullptr if it can't be created
+   */
+  fftw_plan get_many_plan(int npoints, int howmany, int input_distance, int output_distance);
+
+  /**
+   * @brief Same as get_many_plan in single precision
+   */
+  fftwf_plan get_many_plan_float(int npoints, int howmany, int input_distance, int output_distance);
+
+  /**
+   * @brief Load or save the accumulated wisdom, return false if the file can't be used.
+   *        The wisdom of the single precision plans goes to filename + ".float"
+   */
+  bool load_wisdom(const std::string& filename);
+  bool save_wisdom(const std::string& filename);
+
+  /**
+   * @brief Destroy all the plans, they can't be in use
+   */
+  void clear();
+
+private:
+  FourierPlans() = default;
+  ~FourierPlans();
+
+  mutable std::mutex m_mutex;
+  std::map<int, fftw_plan> m_plans;
+  std::map<std::tuple<int, int, int, int>, fftw_plan> m_many_plans;
+  std::map<std::tuple<int, int, int, int>, fftwf_plan> m_many_plans_float;
+  unsigned m_rigor = FFTW_ESTIMATE;
+};
+
+/**
+ * @brief Parse "estimate", "measure" or "patient" into the fftw flag,
+ *        anything else is not valid
+ */
+std::optional<unsigned> parse_fourier_rigor(const std::string& name);
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_ALGS_FOURIERPLANS_HPP_
@@ -0,0 +1,71 @@
+/**
+ * @file FourierWindow.hpp Window functions and lengths for the Fourier transforms
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALGS_FOURIERWINDOW_HPP_
+#define DQM_INCLUDE_DQM_ALGS_FOURIERWINDOW_HPP_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * Window that multiplies the samples before the transform to reduce the
+ * spectral leakage. The windows are periodic (the DFT-even version)
+ */
+enum class FourierWindowType
+{
+  kNone,
+  kHann,
+  kHamming,
+  kBlackman
+};
+
+/**
+ * How the number of points of the transform is chosen from the number of
+ * samples. fftw is fastest for sizes 2^a 3^b 5^c and can be much slower
+ * for sizes with large prime factors
+ */
+enum class FourierLength
+{
+  // Exactly the number of samples
+  kExact,
+  // Largest fast size not larger than the number of samples, the last samples are not used
+  kRoundDown,
+  // Smallest fast size not smaller than the number of samples, padded with zeros
+  kPadUp
+};
+
+/**
+ * @brief n values of the window, empty for FourierWindowType::kNone
+ */
+std::vector<double> make_fourier_window(FourierWindowType type, int n);
+
+/**
+ * @brief Parse "none", "hann", "hamming" or "blackman", anything else is not valid
+ */
+std::optional<FourierWindowType> parse_fourier_window(const std::string& name);
+
+/**
+ * @brief Parse "exact", "down" or "up", anything else is not valid
+ */
+std::optional<FourierLength> parse_fourier_length(const std::string& name);
+
+/**
+ * @brief Whether n = 2^a 3^b 5^c
+ */
+bool is_fast_fourier_length(int n);
+
+/**
+ * @brief Number of points of the transform for nsamples samples
+ */
+int get_fourier_length(int nsamples, FourierLength length);
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_ALGS_FOURIERWINDOW_HPP_
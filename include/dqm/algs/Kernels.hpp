@@ -0,0 +1,123 @@
+/**
+ * @file Kernels.hpp Runtime selection of the vectorized numeric kernels
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALGS_KERNELS_HPP_
+#define DQM_INCLUDE_DQM_ALGS_KERNELS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace dunedaq::dqm {
+
+/**
+ * Instruction sets for which the kernels are compiled. The library is built
+ * for a generic baseline and each variant is compiled with its own target
+ * attribute, so the same binary uses the widest vector units of each host
+ */
+enum class KernelISA
+{
+  kScalar = 0,
+  kSSE42 = 1,
+  kAVX2 = 2,
+  kAVX512 = 3
+};
+
+/**
+ * Everything that is computed in a single pass over the ADC values of a channel.
+ * The kernels add to the sums and counts and update min and max, so that
+ * the same RowSummary can be passed for several rows
+ */
+struct RowSummary
+{
+  uint64_t sum = 0;
+  uint64_t sum_sq = 0;
+  uint16_t min = UINT16_MAX;
+  uint16_t max = 0;
+  uint64_t zeros = 0;
+  uint64_t saturated = 0;
+};
+
+/**
+ * Table with one implementation of every kernel. The statistics and plane
+ * sum kernels expect ADC values below 2^15, which is true for 12 and 14 bit ADCs
+ */
+struct Kernels
+{
+  KernelISA isa;
+
+  /**
+   * @brief Unpack the 256 channels of a WIB2 frame payload, see Unpack.hpp
+   */
+  void (*unpack_wib2)(const uint32_t* adc_words, uint16_t* out);
+
+  /**
+   * @brief Add the sum and the sum of squares of n ADC values to sum and sum_sq
+   */
+  void (*sum_row)(const uint16_t* adcs, size_t n, uint64_t& sum, uint64_t& sum_sq);
+
+  /**
+   * @brief acc[i] += adcs[i] for i < n
+   */
+  void (*add_row)(const uint16_t* adcs, size_t n, double* acc);
+
+  /**
+   * @brief Sums, min, max and the number of values that are 0 or full_scale, see RowSummary
+   */
+  void (*summarize_row)(const uint16_t* adcs, size_t n, uint16_t full_scale, RowSummary& summary);
+
+  /**
+   * @brief out[i] = adcs[i] * window[i] for i < n, to apply a window before a Fourier transform
+   */
+  void (*window_row)(const uint16_t* adcs, const double* window, size_t n, double* out);
+
+  /**
+   * @brief Same as window_row in single precision
+   */
+  void (*window_row_float)(const uint16_t* adcs, const float* window, size_t n, float* out);
+
+  /**
+   * @brief Minimum and maximum of every bucket of consecutive values, out[2 b] and
+   *        out[2 b + 1] for bucket b. The last bucket may have fewer values
+   */
+  void (*envelope_row)(const uint16_t* adcs, size_t n, size_t bucket, uint16_t* out);
+};
+
+/**
+ * @brief Widest instruction set supported by this CPU
+ */
+KernelISA detect_isa();
+
+/**
+ * @brief Choose the kernels for the widest instruction set supported by this CPU
+ *        that is not wider than max_isa. Returns the chosen instruction set
+ */
+KernelISA select_kernels(KernelISA max_isa = KernelISA::kAVX512);
+
+/**
+ * @brief Kernels currently in use. If select_kernels has not been called the
+ *        best ones for this CPU are chosen
+ */
+const Kernels& get_kernels();
+
+/**
+ * @brief Kernels for a given instruction set, ignoring what the CPU supports
+ */
+const Kernels& get_kernels(KernelISA isa);
+
+std::string get_isa_name(KernelISA isa);
+
+/**
+ * @brief Parse "scalar", "sse4.2", "avx2" or "avx512". "auto" means no limit,
+ *        that is KernelISA::kAVX512, and anything else is not valid
+ */
+std::optional<KernelISA> parse_isa_name(const std::string& name);
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_ALGS_KERNELS_HPP_
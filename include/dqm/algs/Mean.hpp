@@ -1,5 +1,5 @@
 /**
- * @file Mean.hpp Simple mean implementation
+ * @file Mean.hpp Mean and moving pedestal of the ADC values of many channels
  *
  * This is part of the DUNE DAQ , copyright 2020.
  * Licensing/copyright details are in the COPYING file that you should have
@@ -8,51 +8,73 @@
 #ifndef DQM_INCLUDE_DQM_MEAN_HPP_
 #define DQM_INCLUDE_DQM_MEAN_HPP_
 
-// DQM
+#include "dqm/AlignedAllocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
 
-/**
- * Basic 1D histogram that counts entries
- * It only supports uniform binning
- * Overflow and underflow is not supported yet
- */
 namespace dunedaq::dqm {
 
+/**
+ * Number of entries and sum of the ADC values of every channel, each one in
+ * its own contiguous array, and a pedestal that follows the mean of every
+ * record with an exponentially weighted moving average:
+ *   pedestal = pedestal + alpha * (mean of the record - pedestal)
+ * The pedestal of the first record is kept as the reference, so the drift
+ * since then is available without keeping any history. clean only resets
+ * the sums, the pedestals are kept until reset
+ */
 class Mean
 {
 
 public:
-  int m_nentries = 0;
-  double m_sum = 0;
+  /**
+   * @param alpha Weight of every new record in the moving pedestal, between 0 and 1
+   */
+  explicit Mean(size_t nchannels = 0, double alpha = 0.1);
+
+  size_t size() const { return m_counts.size(); }
+  double get_alpha() const { return m_alpha; }
 
-  void fill(double x);
+  /**
+   * @brief Add the n ADC values of channel ch in a record, it has to be
+   *        called once per channel and record
+   */
+  void fill(size_t ch, const uint16_t* adcs, size_t n);
 
   void clean();
 
-  double mean();
-};
+  /**
+   * @brief Forget the moving pedestals and their references too
+   */
+  void reset();
 
+  uint64_t get_count(size_t ch) const { return m_counts[ch]; }
+  uint64_t get_sum(size_t ch) const { return m_sums[ch]; }
 
-void
-Mean::fill(double x)
-{
-  m_nentries++;
-  m_sum += x;
-}
+  /**
+   * @brief Mean since the last clean, -1 when there are no entries
+   */
+  double mean(size_t ch) const;
 
-void
-Mean::clean()
-{
-  m_sum = 0;
-  m_nentries = 0;
-}
+  /**
+   * @brief Moving pedestal, -1 when no record has been filled
+   */
+  double pedestal(size_t ch) const { return m_pedestals[ch]; }
 
-double
-Mean::mean()
-{
-  m_mean = m_sum / m_nentries;
-  return m_mean;
-}
+  /**
+   * @brief Moving pedestal minus the one of the first record, 0 when no
+   *        record has been filled
+   */
+  double drift(size_t ch) const;
 
+private:
+  double m_alpha;
+  aligned_vector<uint64_t> m_counts;
+  aligned_vector<uint64_t> m_sums;
+  aligned_vector<double> m_pedestals;
+  aligned_vector<double> m_references;
+};
 
 } // namespace dunedaq::dqm
 
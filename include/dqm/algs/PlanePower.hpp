@@ -0,0 +1,108 @@
+/**
+ * @file PlanePower.hpp Power spectrum averaged over the channels of each plane
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALGS_PLANEPOWER_HPP_
+#define DQM_INCLUDE_DQM_ALGS_PLANEPOWER_HPP_
+
+#include "dqm/AlignedAllocator.hpp"
+#include "dqm/algs/FourierWindow.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * Average of |X_k|^2 over the channels of each group (usually a plane).
+ * Unlike the transform of the summed samples, noise that is not coherent
+ * between channels is not cancelled.
+ *
+ * The channels are transformed in blocks with single precision plans for
+ * many transforms, like FourierBatch<float>, but the input and the output of
+ * a block are per thread buffers and the power is added to the group of
+ * each channel right away. Only the sums of the groups are kept, so the
+ * memory doesn't grow with the number of channels. Blocks can be added from
+ * different threads at the same time
+ */
+class PlanePower
+{
+public:
+  /**
+   * @param inc Time between samples
+   * @param npoints Number of points of the transform of each channel
+   * @param window Window applied to the samples
+   * @param nsamples Number of samples used for each channel, at most npoints,
+   *        the rest of the points are 0. With 0 it is npoints
+   */
+  PlanePower(size_t ngroups,
+             int npoints,
+             double inc,
+             FourierWindowType window = FourierWindowType::kNone,
+             int nsamples = 0);
+
+  size_t size() const { return m_counts.size(); }
+  int get_num_points() const { return m_npoints; }
+  int get_num_samples() const { return m_nsamples; }
+  size_t get_num_frequencies() const { return m_npoints / 2 + 1; }
+
+  /**
+   * @brief Output frequencies (only non-negative frequencies), computed once
+   */
+  const std::vector<double>& get_frequencies() const { return m_frequencies; }
+
+  /**
+   * @brief Transform count channels, at most s_channels_per_block, and add
+   *        their power to their groups. rows[i] has get_num_samples() ADC
+   *        values of a channel of group groups[i]. Returns false if the plan
+   *        couldn't be created
+   */
+  bool add(const uint16_t* const* rows, const int* groups, size_t count);
+
+  void clean();
+
+  uint64_t get_num_channels(size_t group) const { return m_counts[group]; }
+
+  /**
+   * @brief Average power of the channels of a group for each of
+   *        get_frequencies(). All the values are -1 if it has no channels
+   */
+  std::vector<float> get_power(size_t group) const;
+
+  /**
+   * @brief Average power of all the channels of every group
+   */
+  std::vector<float> get_total_power() const;
+
+  // Number of channels transformed together by each plan execution
+  static constexpr size_t s_channels_per_block = 64;
+
+  /**
+   * @brief Create the plan of a full block of transforms of npoints before
+   *        any PlanePower is built, returns false if it can't be created
+   */
+  static bool create_plans(int npoints);
+
+private:
+  int m_npoints;
+  int m_nsamples;
+  double m_inc_size;
+  size_t m_input_stride;
+  size_t m_output_stride;
+  // Empty when there is no window
+  aligned_vector<float> m_window;
+  std::vector<double> m_frequencies;
+  // Sum of |X_k|^2 of the channels of every group, [group][frequency]
+  std::vector<double> m_power;
+  std::vector<uint64_t> m_counts;
+  std::mutex m_mutex;
+};
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_ALGS_PLANEPOWER_HPP_
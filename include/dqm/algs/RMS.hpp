@@ -8,6 +8,9 @@
 #ifndef DQM_INCLUDE_DQM_ALGS_RMS_HPP_
 #define DQM_INCLUDE_DQM_ALGS_RMS_HPP_
 
+#include <cstddef>
+#include <cstdint>
+
 /**
  * Basic RMS calculation implementation
  * Fill values, then compute the RMS at the end
@@ -28,6 +31,11 @@ public:
    */
   void fill(const double x);
 
+  /**
+   * @brief Add n ADC values at once
+   */
+  void fill(const uint16_t* adcs, size_t n);
+
   void clean();
 
   double rms() const;
@@ -0,0 +1,58 @@
+/**
+ * @file RawReduction.hpp Reductions of the raw ADC values of a channel for displaying them
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALGS_RAWREDUCTION_HPP_
+#define DQM_INCLUDE_DQM_ALGS_RAWREDUCTION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * How the raw values of a channel are reduced to about the number of points
+ * that a display can show. The values are split in buckets of consecutive
+ * samples and for each bucket
+ *   kStride sends its first value
+ *   kEnvelope sends its minimum and its maximum, so that spikes are never lost
+ *   kLTTB sends the sample index and the value of one point chosen with
+ *         largest-triangle-three-buckets, which keeps the shape of the waveform.
+ *         The first and the last samples are always sent
+ */
+enum class RawReduction
+{
+  kNone,
+  kStride,
+  kEnvelope,
+  kLTTB
+};
+
+/**
+ * @brief Parse "none", "stride", "envelope" or "lttb", anything else is not valid
+ */
+std::optional<RawReduction> parse_raw_reduction(const std::string& name);
+
+const char* get_raw_reduction_name(RawReduction reduction);
+
+/**
+ * @brief Number of samples in each bucket so that nsamples become at most
+ *        about points buckets, at least 1
+ */
+size_t get_raw_bucket(size_t nsamples, size_t points);
+
+/**
+ * @brief Append the reduction of the n values of adcs with buckets of bucket
+ *        samples to out. With RawReduction::kNone all the values are appended
+ */
+void reduce_raw(RawReduction reduction, const uint16_t* adcs, size_t n, size_t bucket, std::vector<uint32_t>& out);
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_ALGS_RAWREDUCTION_HPP_
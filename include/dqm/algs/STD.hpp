@@ -8,9 +8,14 @@
 #ifndef DQM_INCLUDE_DQM_ALGS_STD_HPP_
 #define DQM_INCLUDE_DQM_ALGS_STD_HPP_
 
+#include <cstddef>
+#include <cstdint>
+
 /**
- * Basic STD calculation implementation
- * Fill values, then compute the STD at the end
+ * STD calculation with a running mean and sum of squared deviations
+ * (Welford), which doesn't lose precision when the values have a large
+ * offset. Partial results, for example from different threads or records,
+ * can be combined with merge (Chan et al.)
  */
 namespace dunedaq {
 namespace dqm {
@@ -19,9 +24,9 @@ class STD
 {
 
 public:
-  int m_nentries = 0;
-  double m_sum = 0, m_sum_sq = 0, m_mean, m_std;
-  bool m_mean_set = false, m_std_set = false;
+  uint64_t m_nentries = 0;
+  // Mean and sum of squared deviations from the mean of the entries so far
+  double m_mean = 0, m_m2 = 0;
 
   /**
    * @brief Add an entry to the histogram
@@ -29,8 +34,19 @@ public:
    */
   void fill(const double x);
 
+  /**
+   * @brief Add n ADC values at once
+   */
+  void fill(const uint16_t* adcs, size_t n);
+
+  /**
+   * @brief Add the entries of other as if they had been filled here
+   */
+  void merge(const STD& other);
+
   void clean();
 
+  double mean() const;
   double std() const;
 };
 
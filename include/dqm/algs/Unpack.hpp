@@ -0,0 +1,36 @@
+/**
+ * @file Unpack.hpp Declarations of kernels that unpack all the channels of a frame at once
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALGS_UNPACK_HPP_
+#define DQM_INCLUDE_DQM_ALGS_UNPACK_HPP_
+
+#include <cstdint>
+
+namespace dunedaq::dqm {
+
+/**
+ * The payload of a WIB2 frame is a little-endian stream of 256 ADC values
+ * of 14 bits each (112 32-bit words). All the kernels take a pointer to the
+ * first payload word and write the 256 values to out
+ */
+constexpr int WIB2_CHANNELS = 256;
+constexpr int WIB2_BITS_PER_ADC = 14;
+constexpr int WIB2_PAYLOAD_BYTES = WIB2_CHANNELS * WIB2_BITS_PER_ADC / 8;
+
+void unpack_wib2_scalar(const uint32_t* adc_words, uint16_t* out);
+void unpack_wib2_sse42(const uint32_t* adc_words, uint16_t* out);
+void unpack_wib2_avx2(const uint32_t* adc_words, uint16_t* out);
+void unpack_wib2_avx512(const uint32_t* adc_words, uint16_t* out);
+
+/**
+ * @brief Unpack using the kernel chosen by select_kernels, see Kernels.hpp
+ */
+void unpack_wib2(const uint32_t* adc_words, uint16_t* out);
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_ALGS_UNPACK_HPP_
@@ -0,0 +1,104 @@
+/**
+ * @file WelchPSD.hpp Power spectral density of many channels averaged over segments and records
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_INCLUDE_DQM_ALGS_WELCHPSD_HPP_
+#define DQM_INCLUDE_DQM_ALGS_WELCHPSD_HPP_
+
+#include "dqm/AlignedAllocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * Welch's method: every series is split in overlapping segments, each one
+ * has its mean removed and is multiplied by a Hann window, and the power
+ * spectra of the segments are averaged. The power is accumulated for every
+ * channel in a fixed size float array, so any number of segments and records
+ * can be added with constant memory.
+ *
+ * The segments of a channel are transformed together with single precision
+ * plans for many transforms from FourierPlans. The result is one-sided, in
+ * ADC^2 / Hz
+ */
+class WelchPSD
+{
+public:
+  /**
+   * @param segment_length Number of samples of each segment
+   * @param overlap Number of samples shared by consecutive segments, smaller than segment_length
+   * @param inc Time between samples
+   */
+  WelchPSD(size_t nchannels, int segment_length, int overlap, double inc);
+
+  size_t size() const { return m_counts.size(); }
+  int get_segment_length() const { return m_segment_length; }
+  size_t get_num_frequencies() const { return m_segment_length / 2 + 1; }
+
+  /**
+   * @brief Add the segments that fit in n samples of channel ch, the
+   *        samples that don't fill a segment are not used
+   */
+  void fill(size_t ch, const uint16_t* adcs, size_t n);
+  void fill(size_t ch, const double* values, size_t n);
+
+  /**
+   * @brief Add the segments of other, that has to have the same parameters
+   */
+  void merge(const WelchPSD& other);
+
+  void clean();
+
+  uint64_t get_num_segments(size_t ch) const { return m_counts[ch]; }
+
+  /**
+   * @brief Average power spectral density of channel ch, one value for each
+   *        of get_frequencies(). All the values are -1 if there are no segments
+   */
+  std::vector<float> get_psd(size_t ch) const;
+
+  std::vector<double> get_frequencies() const;
+
+  /**
+   * @brief Fields added to the header of the messages so that the values of
+   *        each channel can be split and given a frequency: segment_length,
+   *        nfreq and df, the spacing of the frequencies in Hz
+   */
+  std::string get_header_fields() const;
+
+  // Maximum number of segments transformed by each plan execution
+  static constexpr size_t s_segments_per_plan = 32;
+
+  /**
+   * @brief Create the plan for segments of segment_length before any
+   *        WelchPSD is built, returns false if it can't be created
+   */
+  static bool create_plans(int segment_length);
+
+private:
+  template<class T>
+  void add_segments(size_t ch, const T* values, size_t n);
+
+  int m_segment_length;
+  int m_step;
+  double m_inc_size;
+  size_t m_input_stride;
+  size_t m_output_stride;
+  aligned_vector<float> m_window;
+  // Sum of the squares of the window, for the normalization
+  double m_window_power;
+  // Sum of |X_k|^2 over all the segments, [channel][frequency]
+  aligned_vector<float> m_power;
+  std::vector<uint64_t> m_counts;
+};
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_INCLUDE_DQM_ALGS_WELCHPSD_HPP_
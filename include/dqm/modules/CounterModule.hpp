@@ -25,6 +25,8 @@
 #include "daqdataformats/TriggerRecord.hpp"
 #include "fddetdataformats/TDE16Frame.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <map>
 #include <string>
@@ -32,23 +34,50 @@
 
 namespace dunedaq::dqm {
 
-class CounterModule : public ChannelStream<Counter, int>
+/**
+ * Sends the raw ADC values of every channel. They are copied straight from
+ * the frames into the buffer of Counter and from it into the message,
+ * reduced for displaying them if a reduction is chosen. The values are
+ * 32-bit so that the sample indices of the LTTB reduction fit, msgpack
+ * still packs ADC values in at most 3 bytes
+ */
+class CounterModule : public ChannelStream<Counter, uint32_t>
 {
 
 public:
+  /**
+   * @param nsamples Number of samples of each channel that are expected, the
+   *        buffer grows if there are more
+   * @param reduction Reduction of the samples of each channel
+   * @param points Number of buckets each channel is reduced to, about
+   */
   CounterModule(std::string name,
             int nchannels,
-            std::vector<int>& link_idx);
+            std::vector<int>& link_idx,
+            int nsamples = 0,
+            RawReduction reduction = RawReduction::kNone,
+            int points = 0);
 
+private:
+  static Counter make_counter(int nchannels, int nsamples, RawReduction reduction, int points);
 };
 
+Counter
+CounterModule::make_counter(int nchannels, int nsamples, RawReduction reduction, int points)
+{
+  Counter counter(nchannels, std::max(nsamples, 0));
+  counter.set_reduction(reduction, std::max(points, 0));
+  return counter;
+}
+
 CounterModule::CounterModule(std::string name,
                              int nchannels,
-                             std::vector<int>& link_idx
+                             std::vector<int>& link_idx,
+                             int nsamples,
+                             RawReduction reduction,
+                             int points
                      )
-  : ChannelStream(name, nchannels, link_idx,
-                  [this] (std::vector<Counter>& vec, int ch, int link) -> std::vector<int> {
-                    return vec[get_local_index(ch, link)].count;})
+  : ChannelStream(name, link_idx, make_counter(nchannels, nsamples, reduction, points), {{name, nullptr}})
 {
 }
 
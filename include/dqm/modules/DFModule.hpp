@@ -69,7 +69,7 @@ DFModule::DFModule(bool enable_raw, bool enable_rms, bool enable_std, bool enabl
 {
 #ifndef WITH_PYTHON_SUPPORT
   if (m_enable_raw) {
-    m_raw = std::make_shared<CounterModule>("raw", CHANNELS_PER_LINK * m_ids.size(), m_ids);
+    m_raw = std::make_shared<CounterModule>("raw", CHANNELS_PER_LINK * m_ids.size(), m_ids, m_num_frames);
   }
   if (m_enable_rms) {
     m_rms = std::make_shared<RMSModule>("rms", CHANNELS_PER_LINK * m_ids.size(), m_ids);
@@ -9,18 +9,29 @@
 #define DQM_SRC_FOURIERCONTAINER_HPP_
 
 // DQM
+#include "dqm/ADCMatrix.hpp"
 #include "dqm/AnalysisModule.hpp"
+#include "dqm/ChannelGroups.hpp"
 #include "dqm/ChannelMap.hpp"
 #include "dqm/Constants.hpp"
 #include "dqm/Decoder.hpp"
 #include "dqm/Exporter.hpp"
 #include "dqm/algs/Fourier.hpp"
+#include "dqm/algs/FourierBands.hpp"
+#include "dqm/algs/FourierBatch.hpp"
+#include "dqm/algs/FourierWindow.hpp"
+#include "dqm/algs/Kernels.hpp"
 #include "dqm/Issues.hpp"
+#include "dqm/LinkFrames.hpp"
+#include "dqm/WorkerPool.hpp"
 #include "dqm/DQMFormats.hpp"
 #include "dqm/DQMLogging.hpp"
 
 #include "daqdataformats/TriggerRecord.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdlib>
 #include <map>
 #include <memory>
@@ -36,13 +47,71 @@ class FourierContainer : public AnalysisModule
   std::string m_name;
   std::vector<Fourier> fouriervec;
   size_t m_size;
+  // Number of samples used from each record and number of points of the
+  // transforms, they differ when the length is rounded to a fast size
   int m_npoints;
-  std::map<int, int> m_index;
+  int m_transform_points;
+  LinkIndex m_index;
   bool m_global_mode;
+  bool m_single_precision;
+  // All the channels are transformed together when not in global mode,
+  // only one of them is used depending on the precision
+  std::unique_ptr<FourierBatch<double>> m_batch;
+  std::unique_ptr<FourierBatch<float>> m_batch_float;
+  // Magnitudes of the transform of one plane to be serialized, global mode only
+  std::vector<double> m_magnitudes;
+  std::vector<float> m_magnitudes_float;
+  // Channels that are summed for each transform in global mode and the
+  // channel map the planes were taken from
+  ChannelGroups m_groups;
+  const ChannelMap* m_groups_map = nullptr;
+  // What is sent for every channel when not in global mode: the bands, or
+  // every frequency when there are no bands
+  FourierBands m_bands;
+  bool m_half_precision = false;
+  size_t m_max_message_size = 990000;
+  // Values of the channels of one message, reused between messages
+  std::vector<float> m_channel_values;
+  std::vector<uint16_t> m_channel_values_half;
+
+  /**
+   * @brief Fill the batch with the samples of every channel and transform them
+   */
+  template <class B>
+  bool transform_channels(const ADCMatrix& matrix, B& batch, WorkerPool& workers);
+
+  /**
+   * @brief Values sent for one channel of the batch, out has space for one per band or frequency.
+   *        The magnitudes are divided by the number of points, so that the DC term is the
+   *        mean of the (windowed) samples and fits in half precision
+   */
+  template <class B>
+  void get_channel_values(const B& batch, size_t index, float* out) const;
 
 public:
   FourierContainer(std::string name, int size, double inc, int npoints);
-  FourierContainer(std::string name, int size, std::vector<int>& link_idx, double inc, int npoints, bool global_mode=false);
+  /**
+   * @param single_precision Compute the transforms with floats and send the values as floats
+   * @param window Window applied to the samples before the transform
+   * @param length How the number of points of the transforms is chosen from npoints
+   * @param grouping Channels that are summed in global mode. For planes size
+   *        has to be 4 (the three planes and all of them), for FEMBs and
+   *        ASICs size is not used and there is one transform for each
+   */
+  FourierContainer(std::string name, int size, std::vector<int>& link_idx, double inc, int npoints, bool global_mode=false,
+                   bool single_precision=false, FourierWindowType window=FourierWindowType::kNone,
+                   FourierLength length=FourierLength::kExact, ChannelGrouping grouping=ChannelGrouping::kPlane);
+
+  /**
+   * @brief What is sent for every channel when not in global mode
+   * @param nbands Number of logarithmically spaced bands, 0 sends every frequency
+   * @param band_edges Edges of the bands in Hz, if not empty they are used instead of nbands
+   * @param half_precision Send the values as 16-bit floats
+   * @param max_message_size Maximum size in bytes of a message, the channels of
+   *        a plane are split in as many messages as needed
+   */
+  void set_channel_output(int nbands, const std::vector<double>& band_edges, bool half_precision,
+                          size_t max_message_size);
 
   void run(std::shared_ptr<daqdataformats::TriggerRecord> record,
       DQMArgs& args, DQMInfo& info) override;
@@ -52,11 +121,10 @@ public:
        DQMArgs& args, DQMInfo& info);
 
 
-  // void transmit(const std::string& kafka_address,
-  //               std::shared_ptr<ChannelMap> cmap,
-  //               const std::string& topicname,
-  //               int run_num,
-  //               time_t timestamp);
+  void transmit_channels(const std::string& kafka_address,
+                         std::shared_ptr<ChannelMap> cmap,
+                         const std::string& topicname,
+                         int run_num);
   void transmit_global(const std::string &kafka_address,
                        std::shared_ptr<ChannelMap> cmap,
                        const std::string& topicname,
@@ -71,26 +139,61 @@ FourierContainer::FourierContainer(std::string name, int size, double inc, int n
   : m_name(name)
   , m_size(size)
   , m_npoints(npoints)
+  , m_transform_points(npoints)
+  , m_global_mode(false)
+  , m_single_precision(false)
+  , m_batch(std::make_unique<FourierBatch<double>>(m_size, npoints, inc))
 {
-  for (size_t i = 0; i < m_size; ++i) {
-    fouriervec.emplace_back(Fourier(inc, npoints));
-  }
-
 }
 
-FourierContainer::FourierContainer(std::string name, int size, std::vector<int>& link_idx, double inc, int npoints, bool global_mode)
+FourierContainer::FourierContainer(std::string name, int size, std::vector<int>& link_idx, double inc, int npoints, bool global_mode,
+                                   bool single_precision, FourierWindowType window, FourierLength length,
+                                   ChannelGrouping grouping)
   : m_name(name)
   , m_size(size)
-  , m_npoints(npoints)
+  , m_transform_points(get_fourier_length(npoints, length))
+  , m_index(link_idx)
   , m_global_mode(global_mode)
+  , m_single_precision(single_precision)
 {
+  // When rounding down the last samples are not used, when padding up all are used
+  m_npoints = std::min(npoints, m_transform_points);
+  if (!m_global_mode) {
+    if (m_single_precision) {
+      m_batch_float = std::make_unique<FourierBatch<float>>(m_size, m_transform_points, inc, window, m_npoints);
+    } else {
+      m_batch = std::make_unique<FourierBatch<double>>(m_size, m_transform_points, inc, window, m_npoints);
+    }
+    return;
+  }
+  m_groups = ChannelGroups(grouping, m_index);
+  if (grouping != ChannelGrouping::kPlane) {
+    m_size = m_groups.get_num_groups();
+  }
   for (size_t i = 0; i < m_size; ++i) {
-    fouriervec.emplace_back(Fourier(inc, npoints));
+    fouriervec.emplace_back(Fourier(inc, m_transform_points, window, m_npoints));
+  }
+  if (m_single_precision) {
+    m_magnitudes_float.resize(m_transform_points / 2 + 1);
+  } else {
+    m_magnitudes.resize(m_transform_points / 2 + 1);
+  }
+}
+
+void
+FourierContainer::set_channel_output(int nbands, const std::vector<double>& band_edges, bool half_precision,
+                                     size_t max_message_size)
+{
+  m_half_precision = half_precision;
+  m_max_message_size = max_message_size;
+  if (m_global_mode) {
+    return;
   }
-  int channels = 0;
-  for (size_t i = 0; i < link_idx.size(); ++i) {
-    m_index[link_idx[i]] = channels;
-    channels += CHANNELS_PER_LINK;
+  const auto& frequencies = m_batch ? m_batch->get_frequencies() : m_batch_float->get_frequencies();
+  if (!band_edges.empty()) {
+    m_bands = FourierBands(frequencies, band_edges);
+  } else {
+    m_bands = FourierBands(frequencies, FourierBands::log_edges(frequencies, nbands));
   }
 }
 
@@ -101,78 +204,77 @@ FourierContainer::run_(std::shared_ptr<daqdataformats::TriggerRecord> record,
 {
   auto start = std::chrono::steady_clock::now();
   auto map = args.map;
-  auto frames = decode<T>(record, args.max_frames);
-  auto pipe = Pipeline<T>({"remove_empty", "check_empty", "make_same_size", "check_timestamps_aligned"});
-  bool valid_data = pipe(frames);
-  if (!valid_data) {
+  auto matrix = args.matrix_cache->get<T>(record, args);
+  if (!matrix) {
     return;
   }
-
-  //auto size = frames.begin()->second.size();
+  // Every link is used with the same number of samples
+  auto nsamples = matrix->get_min_samples();
 
   // Normal mode, fourier transform for every channel
   if (!m_global_mode) {
-    for (auto& [key, value] : frames) {
-      for (auto& fr : value) {
-        for (size_t ich = 0; ich < CHANNELS_PER_LINK; ++ich) {
-          fill(ich, key, get_adc<T>(fr, ich));
-        }
-      }
+    if (nsamples < static_cast<size_t>(m_npoints)) {
+      ers::info(ParameterChange(ERS_HERE, "Input doesn't have the expected min n_samples for the Fourier transform, " + std::to_string(nsamples) + " instead of "+ std::to_string(m_npoints) + ". Skipping this event."));
+      return;
     }
-    for (size_t ich = 0; ich < m_size; ++ich) {
-      fouriervec[ich].compute_fourier_transform();
+    bool ok = m_batch ? transform_channels(*matrix, *m_batch, *args.workers)
+                      : transform_channels(*matrix, *m_batch_float, *args.workers);
+    if (!ok) {
+      ers::error(CouldNotCreateFourierPlan(ERS_HERE, ""));
+      return;
     }
-    // transmit(args.kafka_address,
-    //          map,
-    //          args.kafka_topic,
-    //          record->get_header_ref().get_run_number(),
-    //          record->get_header_ref().get_trigger_timestamp());
+    if (!args.run_mark.get()) {
+      return;
+    }
+    transmit_channels(args.kafka_address,
+                      map,
+                      args.kafka_topic,
+                      record->get_header_ref().get_run_number());
     auto stop = std::chrono::steady_clock::now();
     info.fourier_channel_time_taken.store(std::chrono::duration_cast<std::chrono::milliseconds>(stop-start).count());
     info.fourier_channel_times_run++;
   }
 
-  // Global mode means adding everything in planes and then all together
+  // Global mode means adding everything in planes and then all together, or
+  // adding the channels of each FEMB or ASIC
   else {
-    // Initialize the vectors with zeroes, the last one can be done by summing
-    // the resulting transform
-    for (size_t i = 0; i < m_size - 1; ++i) {
-      fouriervec[i].m_data = std::vector<double> ((*frames.begin()).second.size(), 0);
+    bool planes = m_groups.get_grouping() == ChannelGrouping::kPlane;
+    // The plan of the planes is made once the channel map is filled
+    if (planes && m_groups_map != map.get()) {
+      m_groups.set_planes(*map);
+      if (map->is_filled()) {
+        m_groups_map = map.get();
+      }
     }
 
-    auto channel_order = map->get_map();
-    for (const auto& [plane, map] : channel_order) {
-      if (plane > 3 ) {
-        ers::error(InvalidInput(ERS_HERE, "Plane " + std::to_string(plane) + " is not a valid plane"));
-        continue;
-      }
-      for (const auto& [offch, pair] : map) {
-        int link = pair.first;
-        int ch = pair.second;
-        if (frames.find(link) == frames.end()) {
-          ers::error(InvalidInput(ERS_HERE, "Link " + std::to_string(link) + " was not present in data"));
-          continue;
-        }
-        for (size_t iframe = 0; iframe < frames[link].size(); ++iframe) {
-          fouriervec[plane].m_data[iframe] += get_adc<T>(frames[link][iframe], ch);
-        }
-      }
+    // Every group is summed into its own vector, for planes the last one can
+    // be done by summing the resulting transforms
+    size_t ngroups = m_groups.get_num_groups();
+    for (size_t i = 0; i < ngroups; ++i) {
+      fouriervec[i].m_data.assign(nsamples, 0);
     }
+    args.workers->parallel_for(ngroups, [&](size_t group) {
+      m_groups.add(*matrix, nsamples, group, fouriervec[group].m_data.data());
+    });
 
-    for (size_t ich = 0; ich < m_size - 1; ++ich) {
-      if (!args.run_mark.get()) {
-        return;
+    if (!args.run_mark.get()) {
+      return;
+    }
+    std::atomic<bool> ok = true;
+    args.workers->parallel_for(ngroups, [&](size_t group) {
+      if (!fouriervec[group].compute_fourier_transform()) {
+        ok = false;
       }
-      fouriervec[ich].compute_fourier_transform();
+    });
+    if (!ok) {
+      clean();
+      return;
     }
     // The last one corresponds can be obtained as the sum of the ones for the planes
     // since the fourier transform is linear
-    std::vector<std::complex<double>> transform(fouriervec[0].m_transform);
-    fouriervec[m_size-1].m_npoints = fouriervec[0].m_npoints;
-    for (size_t i = 0; i < fouriervec[0].m_transform.size(); ++i) {
-      transform[i] += fouriervec[1].m_transform[i] + fouriervec[2].m_transform[i];
+    if (planes) {
+      fouriervec[m_size-1].set_sum({&fouriervec[0], &fouriervec[1], &fouriervec[2]});
     }
-    fouriervec[m_size-1].m_transform = transform;
     transmit_global(args.kafka_address,
                     map,
                     args.kafka_topic,
@@ -185,6 +287,32 @@ FourierContainer::run_(std::shared_ptr<daqdataformats::TriggerRecord> record,
 }
 
 
+template <class B>
+bool
+FourierContainer::transform_channels(const ADCMatrix& matrix, B& batch, WorkerPool& workers)
+{
+  // Only the samples of this record are used, links of the index that
+  // are not in the record are set to 0
+  workers.parallel_for(m_index.size(), [&](size_t link_slot) {
+    int slot = matrix.get_slot(m_index.get_link(link_slot));
+    int offset = link_slot * CHANNELS_PER_LINK;
+    for (int ich = 0; ich < CHANNELS_PER_LINK; ++ich) {
+      if (slot < 0) {
+        batch.clear(ich + offset);
+      } else {
+        batch.fill(ich + offset, matrix.row(slot, ich));
+      }
+    }
+  });
+  std::atomic<bool> ok = true;
+  workers.parallel_for(batch.get_num_blocks(), [&](size_t block) {
+    if (!batch.compute_block(block)) {
+      ok = false;
+    }
+  });
+  return ok;
+}
+
 void
 FourierContainer::run(std::shared_ptr<daqdataformats::TriggerRecord> record,
                       DQMArgs& args, DQMInfo& info)
@@ -206,78 +334,121 @@ FourierContainer::run(std::shared_ptr<daqdataformats::TriggerRecord> record,
   }
 }
 
-// void
-// FourierContainer::transmit(const std::string& kafka_address,
-//                            std::shared_ptr<ChannelMap> cmap,
-//                            const std::string& topicname,
-//                            int run_num,
-//                            time_t timestamp)
-// {
-
-  // // Placeholders
-  // std::string dataname = m_name;
-  // std::string partition = getenv("DUNEDAQ_PARTITION");
-  // std::string app_name = getenv("DUNEDAQ_APPLICATION_NAME");
-  // std::string datasource = partition + "_" + app_name;
-
-  // // One message is sent for every plane
-  // auto channel_order = cmap->get_map();
-  // for (auto& [plane, map] : channel_order) {
-  //   std::stringstream output;
-  //   output << "{";
-  //   output << "\"source\": \"" << datasource << "\",";
-  //   output << "\"run_number\": \"" << run_num << "\",";
-  //   output << "\"partition\": \"" << partition << "\",";
-  //   output << "\"app_name\": \"" << app_name << "\",";
-  //   output << "\"plane\": \"" << plane << "\",";
-  //   output << "\"algorithm\": \"" << "std" << "\"";
-  //   output << "}\n\n\n";
-  //   std::vector<float> freqs = fouriervec[0].get_frequencies();
-  //   auto bytes = serialization::serialize(freqs, serialization::kMsgPack);
-  //   for (auto& b : bytes) {
-  //     output << b;
-  //   }
-  //   output << "\n\n\n";
-  //   std::vector<float> values;
-  //   for (auto& [offch, pair] : map) {
-  //     int link = pair.first;
-  //     int ch = pair.second;
-  //     values.push_back(histvec[get_local_index(ch, link)].std());
-  //   }
-  //   bytes = serialization::serialize(values, serialization::kMsgPack);
-  //   for (auto& b : bytes) {
-  //     output << b;
-  //   }
-  //   TLOG_DEBUG(5) << "Size of the message in bytes: " << output.str().size();
-  //   KafkaExport(kafka_address, output.str(), topicname);
-  // }
-
-  // auto freq = fouriervec[0].get_frequencies();
-  // // One message is sent for every plane
-  // auto channel_order = cmap->get_map();
-  // for (auto& [plane, map] : channel_order) {
-  //   std::stringstream output;
-  //   output << datasource << ";" << dataname << ";" << run_num << ";" << subrun << ";" << event << ";" << timestamp
-  //          << ";" << metadata << ";" << partition << ";" << app_name << ";" << 0 << ";" << plane << ";";
-  //   for (auto& [offch, pair] : map) {
-  //     output << offch << " ";
-  //   }
-  //   output << "\n";
-  //   for (size_t i = 0; i < freq.size(); ++i) {
-  //     output << freq[i] << "\n";
-  //     for (auto& [offch, pair] : map) {
-  //       int link = pair.first;
-  //       int ch = pair.second;
-  //       output << fouriervec[get_local_index(ch, link)].get_transform_at(i) << " ";
-  //     }
-  //     output << "\n";
-  //   }
-  //   TLOG_DEBUG(5) << "Size of the message in bytes: " << output.str().size();
-  //   KafkaExport(kafka_address, output.str(), topicname);
-  // }
-
-  // clean();
-// }
+template <class B>
+void
+FourierContainer::get_channel_values(const B& batch, size_t index, float* out) const
+{
+  auto magnitudes = batch.get_magnitudes(index);
+  size_t nvalues = m_bands.empty() ? batch.get_frequencies().size() : m_bands.size();
+  if (m_bands.empty()) {
+    std::copy(magnitudes, magnitudes + nvalues, out);
+  } else {
+    m_bands.reduce(magnitudes, out);
+  }
+  // The quadratic mean of the bands scales like the magnitudes
+  float scale = 1.f / batch.get_num_points();
+  for (size_t i = 0; i < nvalues; ++i) {
+    out[i] *= scale;
+  }
+}
+
+void
+FourierContainer::transmit_channels(const std::string& kafka_address,
+                                    std::shared_ptr<ChannelMap> cmap,
+                                    const std::string& topicname,
+                                    int run_num)
+{
+  // Placeholders
+  std::string partition = getenv("DUNEDAQ_PARTITION");
+  std::string app_name = getenv("DUNEDAQ_APPLICATION_NAME");
+  std::string datasource = partition + "_" + app_name;
+
+  const auto& frequencies = m_batch ? m_batch->get_frequencies() : m_batch_float->get_frequencies();
+  size_t nvalues = m_bands.empty() ? frequencies.size() : m_bands.size();
+  // Every message has the edges of the bands, or the frequencies when the
+  // whole spectrum is sent
+  auto axis_bytes = serialization::serialize(m_bands.empty() ? frequencies : m_bands.get_edges(),
+                                             serialization::kMsgPack);
+
+  // msgpack takes at most 5 bytes for a channel number or a float32 and 3
+  // for a float16 stored as uint16, the rest of the message is the header,
+  // the axis and the headers of the arrays
+  constexpr size_t fixed_size = 512;
+  size_t bytes_per_channel = 5 + nvalues * (m_half_precision ? 3 : 5);
+  size_t available = m_max_message_size > fixed_size + axis_bytes.size()
+                       ? m_max_message_size - fixed_size - axis_bytes.size() : 0;
+  size_t channels_per_message = std::max<size_t>(1, available / bytes_per_channel);
+
+  // The channels of every plane are sent in as many messages as needed to
+  // keep each one under the maximum size
+  std::vector<int> channels;
+  std::vector<size_t> indexes;
+  for (const auto& [plane, map] : cmap->get_map()) {
+    channels.clear();
+    indexes.clear();
+    for (const auto& [offch, pair] : map) {
+      int slot = m_index.get_slot(pair.first);
+      if (slot < 0) {
+        continue;
+      }
+      channels.push_back(offch);
+      indexes.push_back(pair.second + slot * CHANNELS_PER_LINK);
+    }
+    size_t total_parts = (channels.size() + channels_per_message - 1) / channels_per_message;
+    for (size_t part = 0; part < total_parts; ++part) {
+      size_t first = part * channels_per_message;
+      size_t count = std::min(channels_per_message, channels.size() - first);
+      std::stringstream output;
+      output << "{";
+      output << "\"source\": \"" << datasource << "\",";
+      output << "\"run_number\": \"" << run_num << "\",";
+      output << "\"partition\": \"" << partition << "\",";
+      output << "\"app_name\": \"" << app_name << "\",";
+      output << "\"plane\": \"" << plane << "\",";
+      output << "\"part\": \"" << part + 1 << "\",";
+      output << "\"total_parts\": \"" << total_parts << "\",";
+      output << "\"format\": \"" << (m_bands.empty() ? "spectrum" : "bands") << "\",";
+      output << "\"precision\": \"" << (m_half_precision ? "float16" : "float32") << "\",";
+      output << "\"normalization\": \"npoints\",";
+      output << "\"algorithm\": \"" << "fourier_channel" << "\"";
+      output << "}\n\n\n";
+      std::vector<int> part_channels(channels.begin() + first, channels.begin() + first + count);
+      auto bytes = serialization::serialize(part_channels, serialization::kMsgPack);
+      for (auto& b : bytes) {
+        output << b;
+      }
+      output << "\n\n\n";
+      for (auto& b : axis_bytes) {
+        output << b;
+      }
+      output << "\n\n\n";
+      // Values of every channel one after the other, [channel][band]. The
+      // buffers keep their capacity so they are only allocated once
+      m_channel_values.resize(count * nvalues);
+      for (size_t i = 0; i < count; ++i) {
+        float* out = m_channel_values.data() + i * nvalues;
+        if (m_batch) {
+          get_channel_values(*m_batch, indexes[first + i], out);
+        } else {
+          get_channel_values(*m_batch_float, indexes[first + i], out);
+        }
+      }
+      if (m_half_precision) {
+        m_channel_values_half.resize(m_channel_values.size());
+        std::transform(m_channel_values.begin(), m_channel_values.end(), m_channel_values_half.begin(),
+                       float_to_half_saturated);
+        bytes = serialization::serialize(m_channel_values_half, serialization::kMsgPack);
+      } else {
+        bytes = serialization::serialize(m_channel_values, serialization::kMsgPack);
+      }
+      for (auto& b : bytes) {
+        output << b;
+      }
+      TLOG_DEBUG(5) << "Size of the message in bytes: " << output.str().size();
+      KafkaExport(kafka_address, output.str(), topicname);
+    }
+  }
+}
 
 void
 FourierContainer::transmit_global(const std::string& kafka_address,
@@ -291,30 +462,40 @@ FourierContainer::transmit_global(const std::string& kafka_address,
   std::string app_name = getenv("DUNEDAQ_APPLICATION_NAME");
   std::string datasource = partition + "_" + app_name;
 
-  // One message is sent for every plane
-  for (int plane = 0; plane < 4; plane++) {
+  // One message is sent for every plane, FEMB or ASIC
+  auto grouping = m_groups.get_grouping();
+  for (size_t plane = 0; plane < fouriervec.size(); plane++) {
     std::stringstream output;
     output << "{";
     output << "\"source\": \"" << datasource << "\",";
     output << "\"run_number\": \"" << run_num << "\",";
     output << "\"partition\": \"" << partition << "\",";
     output << "\"app_name\": \"" << app_name << "\",";
-    output << "\"plane\": \"" << plane << "\",";
-    output << "\"algorithm\": \"" << "fourier_plane" << "\"";
+    if (grouping == ChannelGrouping::kPlane) {
+      output << "\"plane\": \"" << plane << "\",";
+      output << "\"algorithm\": \"" << "fourier_plane" << "\"";
+    } else {
+      auto [link, number] = m_groups.get_location(plane);
+      const char* kind = grouping == ChannelGrouping::kFEMB ? "femb" : "asic";
+      output << "\"link\": \"" << link << "\",";
+      output << "\"" << kind << "\": \"" << number << "\",";
+      output << "\"algorithm\": \"" << "fourier_" << kind << "\"";
+    }
     output << "}\n\n\n";
-    std::vector<double> freqs = fouriervec[plane].get_frequencies();
-    auto bytes = serialization::serialize(freqs, serialization::kMsgPack);
+    auto bytes = serialization::serialize(fouriervec[plane].get_frequencies(), serialization::kMsgPack);
     for (auto& b : bytes) {
       output << b;
     }
     output << "\n\n\n";
-    auto tmp = fouriervec[plane].get_transform();
-    std::vector<double> values;
-    values.reserve(tmp.size());
-    for (const auto& v : tmp) {
-      values.push_back(abs(v));
+    // The magnitudes go straight into buffers that are kept between messages
+    if (m_single_precision) {
+      // Sent as float32, half the size of the message
+      fouriervec[plane].get_magnitudes(m_magnitudes_float.data());
+      bytes = serialization::serialize(m_magnitudes_float, serialization::kMsgPack);
+    } else {
+      fouriervec[plane].get_magnitudes(m_magnitudes.data());
+      bytes = serialization::serialize(m_magnitudes, serialization::kMsgPack);
     }
-    bytes = serialization::serialize(values, serialization::kMsgPack);
     for (auto& b : bytes) {
       output << b;
     }
@@ -328,8 +509,8 @@ FourierContainer::transmit_global(const std::string& kafka_address,
 void
 FourierContainer::clean()
 {
-  for (size_t ich = 0; ich < m_size; ++ich) {
-    fouriervec[ich].clean();
+  for (auto& fourier : fouriervec) {
+    fourier.clean();
   }
 }
 
@@ -342,13 +523,13 @@ FourierContainer::fill(int ch, double value)
 void
 FourierContainer::fill(int ch, int link, double value)
 {
-  fouriervec[ch + m_index[link]].fill(value);
+  fouriervec[get_local_index(ch, link)].fill(value);
 }
 
 int
 FourierContainer::get_local_index(int ch, int link)
 {
-  return ch + m_index[link];
+  return ch + m_index.get_slot(link) * CHANNELS_PER_LINK;
 }
 
 } // namespace dunedaq::dqm
@@ -0,0 +1,94 @@
+/**
+ * @file NoiseModule.hpp Pedestal and noise of every channel that are not affected by signals
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_NOISEMODULE_HPP_
+#define DQM_SRC_NOISEMODULE_HPP_
+
+// DQM
+#include "dqm/algs/ADCHist.hpp"
+#include "dqm/ChannelStream.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * Sends the streams median, iqr_noise and truncated_rms, computed from the
+ * histogram of the ADC values of every channel so that nothing is sorted.
+ * Signals and pulses are in the tails of the distribution and barely move
+ * them:
+ *   median is the pedestal
+ *   iqr_noise is the interquartile range divided by 1.349, the standard
+ *   deviation for gaussian noise
+ *   truncated_rms is the standard deviation of the values within
+ *   s_truncation times iqr_noise of the median
+ */
+class NoiseModule : public ChannelStream<ADCHist<uint32_t>, double>
+{
+
+public:
+  /**
+   * @param nbins Number of ADC values of the frontend, 1 << 12 or 1 << 14
+   */
+  NoiseModule(std::string name,
+              int nchannels,
+              std::vector<int>& link_idx,
+              int nbins);
+
+  /**
+   * @brief Interquartile range of a gaussian in units of its standard deviation
+   */
+  static constexpr double s_iqr_to_sigma = 1.349;
+  static constexpr double s_truncation = 3;
+
+  static double iqr_noise(const ADCHist<uint32_t>& hist, size_t ch);
+  static double truncated_rms(const ADCHist<uint32_t>& hist, size_t ch);
+};
+
+NoiseModule::NoiseModule(std::string name,
+                         int nchannels,
+                         std::vector<int>& link_idx,
+                         int nbins)
+  : ChannelStream(name, link_idx, ADCHist<uint32_t>(nchannels, nbins),
+                  {{"median", [this] (ADCHist<uint32_t>& hist, int ch, int link) -> std::vector<double> {
+                      return {hist.quantile(get_local_index(ch, link), 0.5)};}},
+                   {"iqr_noise", [this] (ADCHist<uint32_t>& hist, int ch, int link) -> std::vector<double> {
+                      return {iqr_noise(hist, get_local_index(ch, link))};}},
+                   {"truncated_rms", [this] (ADCHist<uint32_t>& hist, int ch, int link) -> std::vector<double> {
+                      return {truncated_rms(hist, get_local_index(ch, link))};}}})
+{
+}
+
+double
+NoiseModule::iqr_noise(const ADCHist<uint32_t>& hist, size_t ch)
+{
+  if (hist.get_entries(ch) == 0) {
+    return -1;
+  }
+  return (hist.quantile(ch, 0.75) - hist.quantile(ch, 0.25)) / s_iqr_to_sigma;
+}
+
+double
+NoiseModule::truncated_rms(const ADCHist<uint32_t>& hist, size_t ch)
+{
+  double noise = iqr_noise(hist, ch);
+  if (noise < 0) {
+    return -1;
+  }
+  // At least one ADC count on each side so that a channel with almost no
+  // noise doesn't end up with a single bin
+  double half_width = std::max(s_truncation * noise, 1.);
+  double median = hist.quantile(ch, 0.5);
+  return hist.truncated_std(ch, median - half_width, median + half_width);
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_NOISEMODULE_HPP_
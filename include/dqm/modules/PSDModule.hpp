@@ -0,0 +1,52 @@
+/**
+ * @file PSDModule.hpp Power spectral density of every channel with Welch's method
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_PSDMODULE_HPP_
+#define DQM_SRC_PSDMODULE_HPP_
+
+// DQM
+#include "dqm/algs/WelchPSD.hpp"
+#include "dqm/ChannelStream.hpp"
+
+#include <string>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * Sends the power spectral density of every channel, get_num_frequencies()
+ * values per channel. The header of the messages has the segment length, the
+ * number of frequencies and their spacing. Combined with set_window the
+ * average includes the segments of several records
+ */
+class PSDModule : public ChannelStream<WelchPSD, float>
+{
+
+public:
+  PSDModule(std::string name,
+            int nchannels,
+            std::vector<int>& link_idx,
+            int segment_length,
+            int overlap,
+            double inc);
+};
+
+PSDModule::PSDModule(std::string name,
+                     int nchannels,
+                     std::vector<int>& link_idx,
+                     int segment_length,
+                     int overlap,
+                     double inc)
+  : ChannelStream(name, link_idx, WelchPSD(nchannels, segment_length, overlap, inc),
+                  {{name, [this] (WelchPSD& psd, int ch, int link) -> std::vector<float> {
+                      return psd.get_psd(get_local_index(ch, link));}}})
+{
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_PSDMODULE_HPP_
@@ -0,0 +1,54 @@
+/**
+ * @file PedestalModule.hpp Moving pedestal of every channel and its drift since the start of the run
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_PEDESTALMODULE_HPP_
+#define DQM_SRC_PEDESTALMODULE_HPP_
+
+// DQM
+#include "dqm/algs/Mean.hpp"
+#include "dqm/ChannelStream.hpp"
+
+#include <string>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * Sends the streams pedestal and pedestal_drift. The pedestal of every
+ * channel is a moving average of the means of the records, so it follows
+ * slow drifts without long readout windows, and the drift is its change
+ * since the first record of the run. Both are kept across messages, only
+ * the module is built again for a new run
+ */
+class PedestalModule : public ChannelStream<Mean, double>
+{
+
+public:
+  /**
+   * @param alpha Weight of every new record in the moving pedestal
+   */
+  PedestalModule(std::string name,
+                 int nchannels,
+                 std::vector<int>& link_idx,
+                 double alpha);
+};
+
+PedestalModule::PedestalModule(std::string name,
+                               int nchannels,
+                               std::vector<int>& link_idx,
+                               double alpha)
+  : ChannelStream(name, link_idx, Mean(nchannels, alpha),
+                  {{"pedestal", [this] (Mean& mean, int ch, int link) -> std::vector<double> {
+                      return {mean.pedestal(get_local_index(ch, link))};}},
+                   {"pedestal_drift", [this] (Mean& mean, int ch, int link) -> std::vector<double> {
+                      return {mean.drift(get_local_index(ch, link))};}}})
+{
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_PEDESTALMODULE_HPP_
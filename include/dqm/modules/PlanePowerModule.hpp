@@ -0,0 +1,208 @@
+/**
+ * @file PlanePowerModule.hpp Power spectrum averaged over the channels of each plane
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_PLANEPOWERMODULE_HPP_
+#define DQM_SRC_PLANEPOWERMODULE_HPP_
+
+// DQM
+#include "dqm/ADCMatrix.hpp"
+#include "dqm/AnalysisModule.hpp"
+#include "dqm/ChannelGroups.hpp"
+#include "dqm/ChannelMap.hpp"
+#include "dqm/Constants.hpp"
+#include "dqm/Exporter.hpp"
+#include "dqm/algs/FourierWindow.hpp"
+#include "dqm/algs/PlanePower.hpp"
+#include "dqm/Issues.hpp"
+#include "dqm/LinkFrames.hpp"
+#include "dqm/WorkerPool.hpp"
+#include "dqm/DQMFormats.hpp"
+#include "dqm/DQMLogging.hpp"
+
+#include "daqdataformats/TriggerRecord.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+using logging::TLVL_WORK_STEPS;
+
+/**
+ * Sends the average of |X_k|^2 over the channels of each plane and over all
+ * of them, with the same messages as the transform of each plane of
+ * FourierContainer. The transform of every channel is only kept until its
+ * power is added to its plane
+ */
+class PlanePowerModule : public AnalysisModule
+{
+  std::string m_name;
+  LinkIndex m_index;
+  PlanePower m_power;
+  // Plane of every channel and the channel map it was taken from
+  ChannelGroups m_groups;
+  const ChannelMap* m_groups_map = nullptr;
+  // Samples and plane of every channel of the current record
+  std::vector<const uint16_t*> m_rows;
+  std::vector<int> m_row_groups;
+
+public:
+  /**
+   * @param window Window applied to the samples before the transform
+   * @param length How the number of points of the transforms is chosen from npoints
+   */
+  PlanePowerModule(std::string name, std::vector<int>& link_idx, double inc, int npoints,
+                   FourierWindowType window=FourierWindowType::kNone,
+                   FourierLength length=FourierLength::kExact);
+
+  void run(std::shared_ptr<daqdataformats::TriggerRecord> record,
+      DQMArgs& args, DQMInfo& info) override;
+
+  template <class T>
+  void run_(std::shared_ptr<daqdataformats::TriggerRecord> record,
+       DQMArgs& args, DQMInfo& info);
+
+  void transmit(const std::string &kafka_address,
+                const std::string& topicname,
+                int run_num);
+};
+
+PlanePowerModule::PlanePowerModule(std::string name, std::vector<int>& link_idx, double inc, int npoints,
+                                   FourierWindowType window, FourierLength length)
+  : m_name(name)
+  , m_index(link_idx)
+  // When rounding down the last samples are not used, when padding up all are used
+  , m_power(3, get_fourier_length(npoints, length), inc, window,
+            std::min(npoints, get_fourier_length(npoints, length)))
+  , m_groups(ChannelGrouping::kPlane, m_index)
+{
+}
+
+template <class T>
+void
+PlanePowerModule::run_(std::shared_ptr<daqdataformats::TriggerRecord> record,
+                       DQMArgs& args, DQMInfo&)
+{
+  auto map = args.map;
+  auto matrix = args.matrix_cache->get<T>(record, args);
+  if (!matrix) {
+    return;
+  }
+  auto nsamples = matrix->get_min_samples();
+  if (nsamples < static_cast<size_t>(m_power.get_num_samples())) {
+    ers::info(ParameterChange(ERS_HERE, "Input doesn't have the expected min n_samples for the power spectrum of the planes, " + std::to_string(nsamples) + " instead of "+ std::to_string(m_power.get_num_samples()) + ". Skipping this event."));
+    return;
+  }
+
+  // The planes are taken once the channel map is filled
+  if (m_groups_map != map.get()) {
+    m_groups.set_planes(*map);
+    if (map->is_filled()) {
+      m_groups_map = map.get();
+    }
+  }
+
+  // Channels of the links in this record that belong to a plane
+  m_rows.clear();
+  m_row_groups.clear();
+  for (size_t link_slot = 0; link_slot < m_index.size(); ++link_slot) {
+    int slot = matrix->get_slot(m_index.get_link(link_slot));
+    if (slot < 0) {
+      continue;
+    }
+    for (int ich = 0; ich < CHANNELS_PER_LINK; ++ich) {
+      int group = m_groups.get_group(link_slot, ich);
+      if (group >= 0) {
+        m_rows.push_back(matrix->row(slot, ich));
+        m_row_groups.push_back(group);
+      }
+    }
+  }
+
+  size_t block_size = PlanePower::s_channels_per_block;
+  size_t nblocks = (m_rows.size() + block_size - 1) / block_size;
+  std::atomic<bool> ok = true;
+  args.workers->parallel_for(nblocks, [&](size_t block) {
+    size_t first = block * block_size;
+    size_t count = std::min(block_size, m_rows.size() - first);
+    if (!m_power.add(m_rows.data() + first, m_row_groups.data() + first, count)) {
+      ok = false;
+    }
+  });
+  if (!ok) {
+    ers::error(CouldNotCreateFourierPlan(ERS_HERE, ""));
+    m_power.clean();
+    return;
+  }
+  if (args.run_mark.get()) {
+    transmit(args.kafka_address, args.kafka_topic, record->get_header_ref().get_run_number());
+  }
+  m_power.clean();
+}
+
+void
+PlanePowerModule::run(std::shared_ptr<daqdataformats::TriggerRecord> record,
+                      DQMArgs& args, DQMInfo& info)
+{
+  TLOG(TLVL_WORK_STEPS) << "Running the power spectrum of the planes with frontend_type = " << args.frontend_type;
+  auto frontend_type = args.frontend_type;
+  if (frontend_type == "wib") {
+    set_is_running(true);
+    run_<fddetdataformats::WIBFrame>(std::move(record), args, info);
+    set_is_running(false);
+  }
+  else if (frontend_type == "wib2") {
+    set_is_running(true);
+    run_<fddetdataformats::WIB2Frame>(std::move(record), args, info);
+    set_is_running(false);
+  }
+}
+
+void
+PlanePowerModule::transmit(const std::string& kafka_address,
+                           const std::string& topicname,
+                           int run_num)
+{
+  // Placeholders
+  std::string partition = getenv("DUNEDAQ_PARTITION");
+  std::string app_name = getenv("DUNEDAQ_APPLICATION_NAME");
+  std::string datasource = partition + "_" + app_name;
+
+  auto frequency_bytes = serialization::serialize(m_power.get_frequencies(), serialization::kMsgPack);
+  // One message for each plane and the last one for all of them
+  for (size_t plane = 0; plane <= m_power.size(); plane++) {
+    std::stringstream output;
+    output << "{";
+    output << "\"source\": \"" << datasource << "\",";
+    output << "\"run_number\": \"" << run_num << "\",";
+    output << "\"partition\": \"" << partition << "\",";
+    output << "\"app_name\": \"" << app_name << "\",";
+    output << "\"plane\": \"" << plane << "\",";
+    output << "\"algorithm\": \"" << m_name << "\"";
+    output << "}\n\n\n";
+    for (auto& b : frequency_bytes) {
+      output << b;
+    }
+    output << "\n\n\n";
+    auto values = plane < m_power.size() ? m_power.get_power(plane) : m_power.get_total_power();
+    auto bytes = serialization::serialize(values, serialization::kMsgPack);
+    for (auto& b : bytes) {
+      output << b;
+    }
+    TLOG_DEBUG(5) << "Size of the message in bytes: " << output.str().size();
+    KafkaExport(kafka_address, output.str(), topicname);
+  }
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_PLANEPOWERMODULE_HPP_
@@ -72,8 +72,8 @@ PythonModule::run_(std::shared_ptr<daqdataformats::TriggerRecord> record,
 {
   auto start = std::chrono::steady_clock::now();
   auto map = args.map;
-  auto frames = decode<T>(record, args.max_frames);
-  auto pipe = Pipeline<T>({"remove_empty", "check_empty", "make_same_size", "check_timestamps_aligned"});
+  auto frames = decode<T>(record, args.max_frames, args.link_index);
+  StaticPipeline<T, RemoveEmpty, CheckEmpty, CheckTimestampsAligned, AlignTimestamps> pipe;
   bool valid_data = pipe(frames);
   if (!valid_data) {
     return;
@@ -95,7 +95,7 @@ PythonModule::run_(std::shared_ptr<daqdataformats::TriggerRecord> record,
     return;
   }
 
-  typedef std::map<int, std::vector<T*>> mapt;
+  typedef LinkFrames<T> mapt;
   auto channels = MapItem<mapt>::get_channels(frames, map);
   auto planes = MapItem<mapt>::get_planes(frames, map);
 
@@ -9,7 +9,7 @@
 #define DQM_SRC_RMSMODULE_HPP_
 
 // DQM
-#include "dqm/algs/RMS.hpp"
+#include "dqm/algs/ChannelStats.hpp"
 #include "dqm/ChannelStream.hpp"
 
 #include <string>
@@ -17,7 +17,7 @@
 
 namespace dunedaq::dqm {
 
-class RMSModule : public ChannelStream<RMS, double>
+class RMSModule : public ChannelStream<ChannelStats, double>
 {
 
 public:
@@ -32,8 +32,8 @@ RMSModule::RMSModule(std::string name,
                              std::vector<int>& link_idx
                      )
   : ChannelStream(name, nchannels, link_idx,
-                  [this] (std::vector<RMS>& vec, int ch, int link) -> std::vector<double> {
-                    return {vec[get_local_index(ch, link)].rms()};})
+                  [this] (ChannelStats& stats, int ch, int link) -> std::vector<double> {
+                    return {stats.rms(get_local_index(ch, link))};})
 {
 }
 
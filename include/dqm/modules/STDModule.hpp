@@ -9,7 +9,7 @@
 #define DQM_SRC_STDMODULE_HPP_
 
 // DQM
-#include "dqm/algs/STD.hpp"
+#include "dqm/algs/ChannelStats.hpp"
 #include "dqm/ChannelStream.hpp"
 
 #include <string>
@@ -17,7 +17,7 @@
 
 namespace dunedaq::dqm {
 
-class STDModule : public ChannelStream<STD, double>
+class STDModule : public ChannelStream<ChannelStats, double>
 {
 
 public:
@@ -31,8 +31,8 @@ STDModule::STDModule(std::string name,
                              std::vector<int>& link_idx
                      )
   : ChannelStream(name, nchannels, link_idx,
-                  [this] (std::vector<STD>& vec, int ch, int link) -> std::vector<double> {
-                    return {vec[get_local_index(ch, link)].std()};})
+                  [this] (ChannelStats& stats, int ch, int link) -> std::vector<double> {
+                    return {stats.std(get_local_index(ch, link))};})
 {
 }
 
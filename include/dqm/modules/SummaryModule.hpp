@@ -0,0 +1,57 @@
+/**
+ * @file SummaryModule.hpp Several statistics of the ADC distribution of every channel from a single pass
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_SUMMARYMODULE_HPP_
+#define DQM_SRC_SUMMARYMODULE_HPP_
+
+// DQM
+#include "dqm/algs/ChannelSummary.hpp"
+#include "dqm/ChannelStream.hpp"
+
+#include <string>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+/**
+ * Sends the streams summary_std, summary_rms, summary_min, summary_max and
+ * summary_saturation, prefixed so that they are not mixed with the ones of
+ * STDModule and RMSModule, which can use a different window. For saturation
+ * there are two values per channel: the number of values at 0 and at full scale
+ */
+class SummaryModule : public ChannelStream<ChannelSummary, double>
+{
+
+public:
+  SummaryModule(std::string name,
+                int nchannels,
+                std::vector<int>& link_idx);
+};
+
+SummaryModule::SummaryModule(std::string name,
+                             int nchannels,
+                             std::vector<int>& link_idx
+                     )
+  : ChannelStream(name, nchannels, link_idx,
+                  {{"summary_std", [this] (ChannelSummary& summary, int ch, int link) -> std::vector<double> {
+                      return {summary.std(get_local_index(ch, link))};}},
+                   {"summary_rms", [this] (ChannelSummary& summary, int ch, int link) -> std::vector<double> {
+                      return {summary.rms(get_local_index(ch, link))};}},
+                   {"summary_min", [this] (ChannelSummary& summary, int ch, int link) -> std::vector<double> {
+                      return {static_cast<double>(summary.min(get_local_index(ch, link)))};}},
+                   {"summary_max", [this] (ChannelSummary& summary, int ch, int link) -> std::vector<double> {
+                      return {static_cast<double>(summary.max(get_local_index(ch, link)))};}},
+                   {"summary_saturation", [this] (ChannelSummary& summary, int ch, int link) -> std::vector<double> {
+                      int index = get_local_index(ch, link);
+                      return {static_cast<double>(summary.get_zeros(index)),
+                              static_cast<double>(summary.get_saturated(index))};}}})
+{
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_SUMMARYMODULE_HPP_
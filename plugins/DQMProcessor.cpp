@@ -12,10 +12,18 @@
 #include "DQMProcessor.hpp"
 
 // Channel map and other utilities
+#include "dqm/ADCMatrix.hpp"
 #include "dqm/Constants.hpp"
 #include "dqm/DQMLogging.hpp"
+#include "dqm/Issues.hpp"
 #include "dqm/ChannelMap.hpp"
 #include "dqm/ChannelMapFiller.hpp"
+#include "dqm/WorkerPool.hpp"
+#include "dqm/algs/FourierBatch.hpp"
+#include "dqm/algs/FourierPlans.hpp"
+#include "dqm/algs/Kernels.hpp"
+#include "dqm/algs/PlanePower.hpp"
+#include "dqm/algs/WelchPSD.hpp"
 
 // DUNE-DAQ includes
 #include "appfwk/DAQModuleHelper.hpp"
@@ -37,7 +45,12 @@
 #ifndef WITH_PYTHON_SUPPORT
 // Modules with the classes that contain the algorithms
 #include "dqm/modules/CounterModule.hpp"
+#include "dqm/modules/NoiseModule.hpp"
+#include "dqm/modules/PedestalModule.hpp"
+#include "dqm/modules/PlanePowerModule.hpp"
+#include "dqm/modules/PSDModule.hpp"
 #include "dqm/modules/STDModule.hpp"
+#include "dqm/modules/SummaryModule.hpp"
 #include "dqm/modules/RMSModule.hpp"
 #include "dqm/modules/FourierContainer.hpp"
 #else
@@ -75,6 +88,10 @@ DQMProcessor::init(const data_t& init_data)
   if (connection_map.count("trigger_record_input") > 0) {
     m_tr_receiver = get_iom_receiver<std::unique_ptr<daqdataformats::TriggerRecord>>(connection_map["trigger_record_input"]);
   }
+
+  // Choose once the vectorized kernels for this host
+  m_kernel_isa = select_kernels();
+  TLOG() << get_name() << ": using the " << get_isa_name(m_kernel_isa) << " numeric kernels";
 }
 
 void
@@ -105,6 +122,8 @@ DQMProcessor::get_info(opmonlib::InfoCollector& ci, int /*level*/)
   fcr.channel_map_total_channels = m_dqm_info.channel_map_total_channels.load();
   fcr.channel_map_total_planes = m_dqm_info.channel_map_total_planes.load();
 
+  fcr.kernel_isa = static_cast<int>(m_kernel_isa);
+
   ci.add(fcr);
 }
 
@@ -119,10 +138,45 @@ DQMProcessor::do_configure(const nlohmann::json& args)
   m_frontend_type = conf.frontend_type;
 
   m_raw_conf = conf.raw;
+  auto reduction = parse_raw_reduction(conf.raw_reduction);
+  if (!reduction) {
+    ers::warning(InvalidInput(ERS_HERE, "unknown raw_reduction \"" + conf.raw_reduction + "\", using \"none\""));
+  }
+  m_raw_reduction = reduction.value_or(RawReduction::kNone);
+  m_raw_points = conf.raw_points;
   m_rms_conf = conf.rms;
   m_std_conf = conf.std;
+  m_summary_conf = conf.summary;
+  m_noise_conf = conf.noise;
+  m_pedestal_conf = conf.pedestal;
+  m_pedestal_alpha = conf.pedestal_alpha;
   m_fourier_channel_conf = conf.fourier_channel;
   m_fourier_plane_conf = conf.fourier_plane;
+  auto window = parse_fourier_window(conf.fourier_window);
+  if (!window) {
+    ers::warning(InvalidInput(ERS_HERE, "unknown fourier_window \"" + conf.fourier_window + "\", using \"none\""));
+  }
+  m_fourier_window = window.value_or(FourierWindowType::kNone);
+  auto length = parse_fourier_length(conf.fourier_length);
+  if (!length) {
+    ers::warning(InvalidInput(ERS_HERE, "unknown fourier_length \"" + conf.fourier_length + "\", using \"exact\""));
+  }
+  m_fourier_length = length.value_or(FourierLength::kExact);
+  m_fourier_single_precision = conf.fourier_single_precision;
+  auto grouping = parse_channel_grouping(conf.fourier_plane_grouping);
+  if (!grouping) {
+    ers::warning(InvalidInput(ERS_HERE, "unknown fourier_plane_grouping \"" + conf.fourier_plane_grouping +
+                                          "\", using \"plane\""));
+  }
+  m_fourier_plane_grouping = grouping.value_or(ChannelGrouping::kPlane);
+  m_fourier_channel_bands = conf.fourier_channel_bands;
+  m_fourier_channel_band_edges = conf.fourier_channel_band_edges;
+  m_fourier_channel_half_precision = conf.fourier_channel_half_precision;
+  m_fourier_channel_max_message_size = conf.fourier_channel_max_message_size;
+  m_plane_power_conf = conf.plane_power;
+  m_psd_conf = conf.psd;
+  m_psd_segment_length = conf.psd_segment_length;
+  m_psd_overlap = conf.psd_overlap;
 
   m_df_seconds = conf.df_seconds;
   m_df_offset = conf.df_offset;
@@ -138,10 +192,69 @@ DQMProcessor::do_configure(const nlohmann::json& args)
   m_dqm2df_connection = conf.dqm2df_connection_name;
 
   m_max_frames = conf.max_num_frames;
+  m_num_workers = conf.num_workers;
+
+  // The configuration can only limit the instruction set chosen at init. The
+  // kernels are shared by the whole process so they are selected again every
+  // time, otherwise going back to "auto" would keep the previous limit
+  auto max_isa = parse_isa_name(conf.kernel_isa);
+  if (!max_isa) {
+    ers::warning(InvalidInput(ERS_HERE, "unknown kernel_isa \"" + conf.kernel_isa + "\", using \"auto\""));
+  }
+  m_kernel_isa = select_kernels(max_isa.value_or(KernelISA::kAVX512));
+  TLOG() << get_name() << ": using the " << get_isa_name(m_kernel_isa) << " numeric kernels";
+
+  // Create the Fourier plans now, reading them from the wisdom when possible,
+  // instead of when the first transform is computed
+  auto& fourier_plans = FourierPlans::get();
+  auto rigor = parse_fourier_rigor(conf.fourier_planning);
+  if (!rigor) {
+    ers::warning(InvalidInput(ERS_HERE, "unknown fourier_planning \"" + conf.fourier_planning +
+                                          "\", using \"estimate\""));
+  }
+  fourier_plans.set_rigor(rigor.value_or(FFTW_ESTIMATE));
+  if (!conf.fourier_wisdom_file.empty() && !fourier_plans.load_wisdom(conf.fourier_wisdom_file)) {
+    TLOG() << get_name() << ": couldn't load the Fourier wisdom from " << conf.fourier_wisdom_file;
+  }
+  // The same plans that the modules built in do_work will use: blocks of
+  // channels for fourier_channel, single transforms for the sums of
+  // fourier_plane and blocks of single precision transforms for plane_power
+  // and psd
+  size_t nchannels = CHANNELS_PER_LINK * m_link_idx.size();
+  int channel_points = get_fourier_length(m_fourier_channel_conf.num_frames, m_fourier_length);
+  if (channel_points > 0) {
+    bool ok = m_fourier_single_precision ? FourierBatch<float>::create_plans(nchannels, channel_points)
+                                         : FourierBatch<double>::create_plans(nchannels, channel_points);
+    if (!ok) {
+      ers::error(CouldNotCreateFourierPlan(ERS_HERE, std::to_string(channel_points) + " points"));
+    }
+  }
+  for (int npoints : { get_fourier_length(m_fourier_plane_conf.num_frames, m_fourier_length), m_df_num_frames }) {
+    if (npoints > 0 && !fourier_plans.get_plan(npoints)) {
+      ers::error(CouldNotCreateFourierPlan(ERS_HERE, std::to_string(npoints) + " points"));
+    }
+  }
+  // Trigger records from DF are transformed per channel in double precision
+  if (m_df_num_frames > 0 && !FourierBatch<double>::create_plans(nchannels, m_df_num_frames)) {
+    ers::error(CouldNotCreateFourierPlan(ERS_HERE, std::to_string(m_df_num_frames) + " points"));
+  }
+  int plane_power_points = get_fourier_length(m_plane_power_conf.num_frames, m_fourier_length);
+  if (plane_power_points > 0 && !PlanePower::create_plans(plane_power_points)) {
+    ers::error(CouldNotCreateFourierPlan(ERS_HERE, std::to_string(plane_power_points) + " points"));
+  }
+  if (m_psd_segment_length > 0 && !WelchPSD::create_plans(m_psd_segment_length)) {
+    ers::error(CouldNotCreateFourierPlan(ERS_HERE, std::to_string(m_psd_segment_length) + " points"));
+  }
+  if (!conf.fourier_wisdom_file.empty() && !fourier_plans.save_wisdom(conf.fourier_wisdom_file)) {
+    TLOG() << get_name() << ": couldn't save the Fourier wisdom to " << conf.fourier_wisdom_file;
+  }
 
   m_dqm_args = DQMArgs{m_run_marker, std::shared_ptr<ChannelMap>(new ChannelMap),
                        m_frontend_type, m_kafka_address,
-                       m_kafka_topic, m_max_frames};
+                       m_kafka_topic, m_max_frames,
+                       std::make_shared<ADCMatrixCache>(),
+                       std::make_shared<const LinkIndex>(m_link_idx),
+                       std::make_shared<WorkerPool>(m_num_workers)};
 
   // if we are in readout mode and we don't have the appropriate connections,
   // complain loudly
@@ -245,11 +358,28 @@ DQMProcessor::do_work()
 #ifndef WITH_PYTHON_SUPPORT
   // Raw event display
   auto raw = std::make_shared<CounterModule>(
-        "raw", CHANNELS_PER_LINK * m_link_idx.size(), m_link_idx);
+        "raw", CHANNELS_PER_LINK * m_link_idx.size(), m_link_idx, m_raw_conf.num_frames, m_raw_reduction, m_raw_points);
   // STD
   auto std = std::make_shared<STDModule>("std", CHANNELS_PER_LINK * m_link_idx.size(), m_link_idx);
   // RMS
   auto rms = std::make_shared<RMSModule>("rms", CHANNELS_PER_LINK * m_link_idx.size(), m_link_idx);
+  // STD, RMS, min, max and saturation from a single pass
+  auto summary = std::make_shared<SummaryModule>("summary", CHANNELS_PER_LINK * m_link_idx.size(), m_link_idx);
+  std->set_window(m_std_conf.window_records, m_std_conf.sliding_window);
+  rms->set_window(m_rms_conf.window_records, m_rms_conf.sliding_window);
+  summary->set_window(m_summary_conf.window_records, m_summary_conf.sliding_window);
+  // Median, interquartile range and truncated RMS from a histogram with a bin
+  // for every ADC value. The histograms take tens of KiB per channel (and
+  // record of a sliding window) so they are only built when noise is enabled
+  std::shared_ptr<NoiseModule> noise;
+  if (m_noise_conf.how_often > 0) {
+    noise = std::make_shared<NoiseModule>("noise", CHANNELS_PER_LINK * m_link_idx.size(), m_link_idx,
+                                          (m_frontend_type == "wib") ? 1 << 12 : 1 << 14);
+    noise->set_window(m_noise_conf.window_records, m_noise_conf.sliding_window);
+  }
+  // Pedestal followed with a moving average over the records
+  auto pedestal = std::make_shared<PedestalModule>("pedestal", CHANNELS_PER_LINK * m_link_idx.size(), m_link_idx,
+                                                   m_pedestal_alpha);
   // Fourier transform
   // The Delta of time between frames is the inverse of the sampling frequency (clock frequency)
   // but because we are sampling every TICKS_BETWEEN_TIMESTAMP ticks we have to multiply by that
@@ -257,13 +387,40 @@ DQMProcessor::do_work()
                                                       CHANNELS_PER_LINK * m_link_idx.size(),
                                                       m_link_idx,
                                                             1. / m_clock_frequency * ((m_frontend_type == "wib") ? 25 : 32),
-                                                      m_fourier_channel_conf.num_frames);
+                                                      m_fourier_channel_conf.num_frames,
+                                                      false,
+                                                      m_fourier_single_precision,
+                                                      m_fourier_window,
+                                                      m_fourier_length);
+  fourier_channel->set_channel_output(m_fourier_channel_bands,
+                                      m_fourier_channel_band_edges,
+                                      m_fourier_channel_half_precision,
+                                      m_fourier_channel_max_message_size);
   auto fourier_plane = std::make_shared<FourierContainer>("fourier_plane",
                                                       4,
                                                       m_link_idx,
                                                        1. / m_clock_frequency * ((m_frontend_type == "wib") ? 25 : 32),
                                                       m_fourier_plane_conf.num_frames,
-                                                      true);
+                                                      true,
+                                                      m_fourier_single_precision,
+                                                      m_fourier_window,
+                                                      m_fourier_length,
+                                                      m_fourier_plane_grouping);
+  // Power spectrum of every channel averaged over each plane
+  auto plane_power = std::make_shared<PlanePowerModule>("plane_power",
+                                                        m_link_idx,
+                                                        1. / m_clock_frequency * ((m_frontend_type == "wib") ? 25 : 32),
+                                                        m_plane_power_conf.num_frames,
+                                                        m_fourier_window,
+                                                        m_fourier_length);
+  // Power spectral density, averaged over segments and records
+  auto psd = std::make_shared<PSDModule>("psd",
+                                         CHANNELS_PER_LINK * m_link_idx.size(),
+                                         m_link_idx,
+                                         m_psd_segment_length,
+                                         m_psd_overlap,
+                                         1. / m_clock_frequency * ((m_frontend_type == "wib") ? 25 : 32));
+  psd->set_window(m_psd_conf.window_records, m_psd_conf.sliding_window);
 
 
 
@@ -294,6 +451,30 @@ DQMProcessor::do_work()
       nullptr,
       "RMS every " + std::to_string(m_rms_conf.how_often) + " s"
     };
+  if (m_summary_conf.how_often > 0)
+    map[std::chrono::system_clock::now() + std::chrono::seconds(m_offset_from_channel_map)] = {
+      summary,
+      m_summary_conf.how_often,
+      m_summary_conf.num_frames,
+      nullptr,
+      "Summary every " + std::to_string(m_summary_conf.how_often) + " s"
+    };
+  if (m_noise_conf.how_often > 0)
+    map[std::chrono::system_clock::now() + std::chrono::seconds(m_offset_from_channel_map)] = {
+      noise,
+      m_noise_conf.how_often,
+      m_noise_conf.num_frames,
+      nullptr,
+      "Noise every " + std::to_string(m_noise_conf.how_often) + " s"
+    };
+  if (m_pedestal_conf.how_often > 0)
+    map[std::chrono::system_clock::now() + std::chrono::seconds(m_offset_from_channel_map)] = {
+      pedestal,
+      m_pedestal_conf.how_often,
+      m_pedestal_conf.num_frames,
+      nullptr,
+      "Pedestal every " + std::to_string(m_pedestal_conf.how_often) + " s"
+    };
   if (m_fourier_channel_conf.how_often > 0)
     map[std::chrono::system_clock::now() + std::chrono::seconds(m_offset_from_channel_map)] = {
       fourier_channel,
@@ -312,6 +493,24 @@ DQMProcessor::do_work()
       "Fourier (for every plane) every " + std::to_string(m_fourier_plane_conf.how_often) + " s"
     };
 
+  if (m_plane_power_conf.how_often > 0)
+    map[std::chrono::system_clock::now() + std::chrono::seconds(m_offset_from_channel_map)] = {
+      plane_power,
+      m_plane_power_conf.how_often,
+      m_plane_power_conf.num_frames,
+      nullptr,
+      "Power spectrum of the planes every " + std::to_string(m_plane_power_conf.how_often) + " s"
+    };
+
+  if (m_psd_conf.how_often > 0)
+    map[std::chrono::system_clock::now() + std::chrono::seconds(m_offset_from_channel_map)] = {
+      psd,
+      m_psd_conf.how_often,
+      m_psd_conf.num_frames,
+      nullptr,
+      "Power spectral density every " + std::to_string(m_psd_conf.how_often) + " s"
+    };
+
   if (m_mode == "df" && m_df_seconds > 0) {
     map[std::chrono::system_clock::now() + std::chrono::milliseconds(1000 * m_offset_from_channel_map + static_cast<int>(m_df_offset * 1000))] = {
       dfmodule,
@@ -327,8 +526,8 @@ DQMProcessor::do_work()
   np::initialize();
 
 
-typedef std::map<int, std::vector<fddetdataformats::WIBFrame*>> mapt;
-  p::class_<std::map<int, std::vector<fddetdataformats::WIBFrame*>>>("MapWithFrames")
+typedef LinkFrames<fddetdataformats::WIBFrame> mapt;
+  p::class_<mapt>("MapWithFrames")
   .def("__len__", &mapt::size)
   .def("__getitem__", &MapItem<mapt>::get
       // return_value_policy<copy_non_const_reference>()
@@ -16,8 +16,12 @@
 #include "dqm/dqmprocessor/Structs.hpp"
 #include "dqm/dqmprocessorinfo/InfoNljs.hpp"
 
+#include "dqm/ChannelGroups.hpp"
 #include "dqm/ChannelMap.hpp"
 #include "dqm/DQMFormats.hpp"
+#include "dqm/algs/FourierWindow.hpp"
+#include "dqm/algs/Kernels.hpp"
+#include "dqm/algs/RawReduction.hpp"
 
 #include "appfwk/DAQModule.hpp"
 #include "iomanager/IOManager.hpp"
@@ -80,10 +84,28 @@ private:
 
   // Configuration parameters
   dqmprocessor::StandardDQM m_raw_conf;
-  dqmprocessor::StandardDQM m_std_conf;
-  dqmprocessor::StandardDQM m_rms_conf;
+  RawReduction m_raw_reduction {RawReduction::kNone};
+  int m_raw_points {1000};
+  dqmprocessor::WindowedDQM m_std_conf;
+  dqmprocessor::WindowedDQM m_rms_conf;
+  dqmprocessor::WindowedDQM m_summary_conf;
+  dqmprocessor::WindowedDQM m_noise_conf;
+  dqmprocessor::StandardDQM m_pedestal_conf;
+  double m_pedestal_alpha {0.1};
   dqmprocessor::StandardDQM m_fourier_channel_conf;
   dqmprocessor::StandardDQM m_fourier_plane_conf;
+  FourierWindowType m_fourier_window {FourierWindowType::kNone};
+  FourierLength m_fourier_length {FourierLength::kExact};
+  bool m_fourier_single_precision {false};
+  ChannelGrouping m_fourier_plane_grouping {ChannelGrouping::kPlane};
+  int m_fourier_channel_bands {64};
+  std::vector<double> m_fourier_channel_band_edges;
+  bool m_fourier_channel_half_precision {false};
+  int m_fourier_channel_max_message_size {990000};
+  dqmprocessor::StandardDQM m_plane_power_conf;
+  dqmprocessor::WindowedDQM m_psd_conf;
+  int m_psd_segment_length {256};
+  int m_psd_overlap {128};
 
   // DF configuration parameters
   int m_df_seconds {0};
@@ -122,6 +144,8 @@ private:
   DQMArgs m_dqm_args;
   DQMInfo m_dqm_info;
   int m_max_frames;
+  int m_num_workers {1};
+  KernelISA m_kernel_isa {KernelISA::kScalar};
 
   // Constants used in DQMProcessor.cpp
   static constexpr int m_channel_map_delay {2};                // How much time in s to wait until running the channel map
@@ -0,0 +1,238 @@
+/**
+ * @file ADCHist.cpp Histograms of the ADC values of many channels with one bin for every value
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_ADCHIST_CPP_
+#define DQM_SRC_DQM_ALGS_ADCHIST_CPP_
+
+#include "dqm/algs/ADCHist.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+namespace {
+
+/**
+ * @brief count + add, saturating at the maximum of C
+ */
+template<class C>
+C
+add_saturated(C count, uint64_t add)
+{
+  uint64_t max = std::numeric_limits<C>::max();
+  return static_cast<C>(std::min<uint64_t>(max, count + add));
+}
+
+} // namespace
+
+template<class C>
+ADCHist<C>::ADCHist(size_t nchannels, int nbins, int low)
+  : m_nbins(nbins)
+  , m_low(low)
+  , m_stride(pad_to_cache_line<C>(nbins))
+  , m_bins(nchannels * m_stride, 0)
+  , m_underflow(nchannels, 0)
+  , m_overflow(nchannels, 0)
+  , m_first_bin(nchannels, nbins)
+  , m_last_bin(nchannels, -1)
+{
+}
+
+template<class C>
+void
+ADCHist<C>::fill(size_t ch, const uint16_t* adcs, size_t n)
+{
+  if (n == 0) {
+    return;
+  }
+  // The values of a channel are usually a few counts around the pedestal,
+  // so the values are counted in small histograms that only cover [lo, hi]
+  uint16_t lo = adcs[0];
+  uint16_t hi = adcs[0];
+  for (size_t i = 1; i < n; ++i) {
+    lo = std::min(lo, adcs[i]);
+    hi = std::max(hi, adcs[i]);
+  }
+  size_t width = hi - lo + 1;
+
+  // Consecutive values are often the same, with several histograms filled in
+  // turns each increment doesn't have to wait for the previous one to the
+  // same counter. Every thread reuses its own buffer
+  thread_local std::vector<uint32_t> sub;
+  sub.assign(s_num_sub * width, 0);
+  uint32_t* sub0 = sub.data();
+  uint32_t* sub1 = sub0 + width;
+  uint32_t* sub2 = sub1 + width;
+  uint32_t* sub3 = sub2 + width;
+  size_t i = 0;
+  for (; i + s_num_sub <= n; i += s_num_sub) {
+    ++sub0[adcs[i] - lo];
+    ++sub1[adcs[i + 1] - lo];
+    ++sub2[adcs[i + 2] - lo];
+    ++sub3[adcs[i + 3] - lo];
+  }
+  for (; i < n; ++i) {
+    ++sub0[adcs[i] - lo];
+  }
+
+  C* bins = row(ch);
+  for (size_t v = 0; v < width; ++v) {
+    uint64_t count = static_cast<uint64_t>(sub0[v]) + sub1[v] + sub2[v] + sub3[v];
+    if (count == 0) {
+      continue;
+    }
+    int bin = static_cast<int>(lo + v) - m_low;
+    if (bin < 0) {
+      m_underflow[ch] += count;
+    } else if (bin >= m_nbins) {
+      m_overflow[ch] += count;
+    } else {
+      bins[bin] = add_saturated(bins[bin], count);
+      m_first_bin[ch] = std::min(m_first_bin[ch], bin);
+      m_last_bin[ch] = std::max(m_last_bin[ch], bin);
+    }
+  }
+}
+
+template<class C>
+void
+ADCHist<C>::merge(const ADCHist& other)
+{
+  // Only the bins that have entries in other
+  for (size_t ch = 0; ch < size(); ++ch) {
+    C* bins = row(ch);
+    const C* other_bins = other.get_bins(ch);
+    for (int b = other.m_first_bin[ch]; b <= other.m_last_bin[ch]; ++b) {
+      bins[b] = add_saturated(bins[b], other_bins[b]);
+    }
+    m_underflow[ch] += other.m_underflow[ch];
+    m_overflow[ch] += other.m_overflow[ch];
+    m_first_bin[ch] = std::min(m_first_bin[ch], other.m_first_bin[ch]);
+    m_last_bin[ch] = std::max(m_last_bin[ch], other.m_last_bin[ch]);
+  }
+}
+
+template<class C>
+void
+ADCHist<C>::clean()
+{
+  // Only the bins that have been filled, the rest are already 0
+  for (size_t ch = 0; ch < size(); ++ch) {
+    if (m_first_bin[ch] <= m_last_bin[ch]) {
+      std::fill(row(ch) + m_first_bin[ch], row(ch) + m_last_bin[ch] + 1, 0);
+    }
+  }
+  std::fill(m_underflow.begin(), m_underflow.end(), 0);
+  std::fill(m_overflow.begin(), m_overflow.end(), 0);
+  std::fill(m_first_bin.begin(), m_first_bin.end(), m_nbins);
+  std::fill(m_last_bin.begin(), m_last_bin.end(), -1);
+}
+
+template<class C>
+uint64_t
+ADCHist<C>::get_entries(size_t ch) const
+{
+  const C* bins = get_bins(ch);
+  uint64_t entries = 0;
+  for (int b = m_first_bin[ch]; b <= m_last_bin[ch]; ++b) {
+    entries += bins[b];
+  }
+  return entries;
+}
+
+template<class C>
+double
+ADCHist<C>::mean(size_t ch) const
+{
+  const C* bins = get_bins(ch);
+  uint64_t entries = 0;
+  uint64_t sum = 0;
+  for (int b = m_first_bin[ch]; b <= m_last_bin[ch]; ++b) {
+    entries += bins[b];
+    sum += static_cast<uint64_t>(bins[b]) * b;
+  }
+  if (entries == 0) {
+    return -1;
+  }
+  return m_low + static_cast<double>(sum) / entries;
+}
+
+template<class C>
+double
+ADCHist<C>::std(size_t ch) const
+{
+  uint64_t entries = get_entries(ch);
+  if (entries <= 1) {
+    return -1;
+  }
+  // Deviations from the mean so that there is no cancellation
+  double mean_bin = mean(ch) - m_low;
+  const C* bins = get_bins(ch);
+  double sum_sq = 0;
+  for (int b = m_first_bin[ch]; b <= m_last_bin[ch]; ++b) {
+    if (bins[b]) {
+      sum_sq += bins[b] * (b - mean_bin) * (b - mean_bin);
+    }
+  }
+  return std::sqrt(sum_sq / (entries - 1));
+}
+
+template<class C>
+double
+ADCHist<C>::quantile(size_t ch, double q) const
+{
+  uint64_t entries = get_entries(ch);
+  if (entries == 0) {
+    return -1;
+  }
+  const C* bins = get_bins(ch);
+  double target = q * entries;
+  uint64_t below = 0;
+  for (int b = m_first_bin[ch]; b <= m_last_bin[ch]; ++b) {
+    if (bins[b] && below + bins[b] >= target) {
+      return m_low + b - 0.5 + (target - below) / bins[b];
+    }
+    below += bins[b];
+  }
+  return m_low + m_last_bin[ch] + 0.5;
+}
+
+template<class C>
+double
+ADCHist<C>::truncated_std(size_t ch, double low, double high) const
+{
+  int first = std::max(m_first_bin[ch], static_cast<int>(std::ceil(low)) - m_low);
+  int last = std::min(m_last_bin[ch], static_cast<int>(std::floor(high)) - m_low);
+  const C* bins = get_bins(ch);
+  uint64_t entries = 0;
+  uint64_t sum = 0;
+  for (int b = first; b <= last; ++b) {
+    entries += bins[b];
+    sum += static_cast<uint64_t>(bins[b]) * (b - first);
+  }
+  if (entries <= 1) {
+    return -1;
+  }
+  double mean_bin = static_cast<double>(sum) / entries + first;
+  double sum_sq = 0;
+  for (int b = first; b <= last; ++b) {
+    if (bins[b]) {
+      sum_sq += bins[b] * (b - mean_bin) * (b - mean_bin);
+    }
+  }
+  return std::sqrt(sum_sq / (entries - 1));
+}
+
+template class ADCHist<uint16_t>;
+template class ADCHist<uint32_t>;
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_DQM_ALGS_ADCHIST_CPP_
@@ -0,0 +1,92 @@
+/**
+ * @file ChannelStats.cpp Moments of the ADC distribution of many channels stored as separate arrays
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_CHANNELSTATS_CPP_
+#define DQM_SRC_DQM_ALGS_CHANNELSTATS_CPP_
+
+#include "dqm/algs/ChannelStats.hpp"
+#include "dqm/algs/Kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dunedaq {
+namespace dqm {
+
+namespace {
+// __extension__ keeps -pedantic quiet about the GCC 128-bit type
+__extension__ typedef unsigned __int128 uint128_t;
+}
+
+ChannelStats::ChannelStats(size_t nchannels)
+  : m_counts(nchannels, 0)
+  , m_sums(nchannels, 0)
+  , m_sums_sq(nchannels, 0)
+{
+}
+
+void
+ChannelStats::fill(size_t ch, const uint16_t* adcs, size_t n)
+{
+  get_kernels().sum_row(adcs, n, m_sums[ch], m_sums_sq[ch]);
+  m_counts[ch] += n;
+}
+
+void
+ChannelStats::merge(const ChannelStats& other)
+{
+  // The sums are exact so partial results can be added in any order
+  for (size_t ch = 0; ch < size(); ++ch) {
+    m_counts[ch] += other.m_counts[ch];
+    m_sums[ch] += other.m_sums[ch];
+    m_sums_sq[ch] += other.m_sums_sq[ch];
+  }
+}
+
+void
+ChannelStats::clean()
+{
+  std::fill(m_counts.begin(), m_counts.end(), 0);
+  std::fill(m_sums.begin(), m_sums.end(), 0);
+  std::fill(m_sums_sq.begin(), m_sums_sq.end(), 0);
+}
+
+double
+ChannelStats::mean(size_t ch) const
+{
+  if (not m_counts[ch]) {
+    return -1;
+  }
+  return static_cast<double>(m_sums[ch]) / m_counts[ch];
+}
+
+double
+ChannelStats::std(size_t ch) const
+{
+  auto n = m_counts[ch];
+  if (n <= 1) {
+    return -1;
+  }
+  // n * sum_sq - sum^2 is computed with integers so there is no cancellation
+  uint128_t sum = m_sums[ch];
+  uint128_t numerator = static_cast<uint128_t>(n) * m_sums_sq[ch] - sum * sum;
+  return std::sqrt(static_cast<double>(numerator) / n / (n - 1));
+}
+
+double
+ChannelStats::rms(size_t ch) const
+{
+  if (not m_counts[ch]) {
+    return -1;
+  }
+  return std::sqrt(static_cast<double>(m_sums_sq[ch]) / m_counts[ch]);
+}
+
+} // namespace dunedaq
+} // namespace dqm
+
+#endif // DQM_SRC_DQM_ALGS_CHANNELSTATS_CPP_
@@ -0,0 +1,87 @@
+/**
+ * @file ChannelSummary.cpp Moments, extremes and saturation of the ADC distribution of many channels
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_CHANNELSUMMARY_CPP_
+#define DQM_SRC_DQM_ALGS_CHANNELSUMMARY_CPP_
+
+#include "dqm/algs/ChannelSummary.hpp"
+#include "dqm/algs/Kernels.hpp"
+
+#include <algorithm>
+
+namespace dunedaq {
+namespace dqm {
+
+ChannelSummary::ChannelSummary(size_t nchannels)
+  : ChannelStats(nchannels)
+  , m_mins(nchannels, UINT16_MAX)
+  , m_maxs(nchannels, 0)
+  , m_zeros(nchannels, 0)
+  , m_saturated(nchannels, 0)
+{
+}
+
+void
+ChannelSummary::fill(size_t ch, const uint16_t* adcs, size_t n)
+{
+  RowSummary summary;
+  summary.min = m_mins[ch];
+  summary.max = m_maxs[ch];
+  get_kernels().summarize_row(adcs, n, m_full_scale, summary);
+  m_counts[ch] += n;
+  m_sums[ch] += summary.sum;
+  m_sums_sq[ch] += summary.sum_sq;
+  m_mins[ch] = summary.min;
+  m_maxs[ch] = summary.max;
+  m_zeros[ch] += summary.zeros;
+  m_saturated[ch] += summary.saturated;
+}
+
+void
+ChannelSummary::merge(const ChannelSummary& other)
+{
+  ChannelStats::merge(other);
+  for (size_t ch = 0; ch < size(); ++ch) {
+    m_mins[ch] = std::min(m_mins[ch], other.m_mins[ch]);
+    m_maxs[ch] = std::max(m_maxs[ch], other.m_maxs[ch]);
+    m_zeros[ch] += other.m_zeros[ch];
+    m_saturated[ch] += other.m_saturated[ch];
+  }
+}
+
+void
+ChannelSummary::clean()
+{
+  ChannelStats::clean();
+  std::fill(m_mins.begin(), m_mins.end(), UINT16_MAX);
+  std::fill(m_maxs.begin(), m_maxs.end(), 0);
+  std::fill(m_zeros.begin(), m_zeros.end(), 0);
+  std::fill(m_saturated.begin(), m_saturated.end(), 0);
+}
+
+int
+ChannelSummary::min(size_t ch) const
+{
+  if (not m_counts[ch]) {
+    return -1;
+  }
+  return m_mins[ch];
+}
+
+int
+ChannelSummary::max(size_t ch) const
+{
+  if (not m_counts[ch]) {
+    return -1;
+  }
+  return m_maxs[ch];
+}
+
+} // namespace dunedaq
+} // namespace dqm
+
+#endif // DQM_SRC_DQM_ALGS_CHANNELSUMMARY_CPP_
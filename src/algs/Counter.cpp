@@ -1,5 +1,5 @@
 /**
- * @file Counter.cxx Simple counter implementation
+ * @file Counter.cpp Raw ADC values of many channels in a single buffer
  *
  * This is part of the DUNE DAQ , copyright 2020.
  * Licensing/copyright details are in the COPYING file that you should have
@@ -10,25 +10,83 @@
 
 #include "dqm/algs/Counter.hpp"
 
-/**
- * Basic Counter implementation
- * Fill values and store them
- */
+#include <algorithm>
+
 namespace dunedaq {
 namespace dqm {
 
+Counter::Counter(size_t nchannels, size_t nsamples)
+  : m_stride(pad_to_cache_line<uint16_t>(nsamples))
+  , m_data(nchannels * m_stride)
+  , m_sizes(nchannels, 0)
+{
+}
+
 void
-Counter::fill(double const x)
+Counter::reserve_samples(size_t n)
 {
-  m_nentries++;
-  count.push_back(x);
+  size_t largest = m_sizes.empty() ? 0 : *std::max_element(m_sizes.begin(), m_sizes.end());
+  if (largest + n <= m_stride) {
+    return;
+  }
+  // Only happens when more samples than expected arrive, the samples
+  // already there are moved to the new rows
+  size_t stride = pad_to_cache_line<uint16_t>(largest + n);
+  aligned_vector<uint16_t> data(size() * stride);
+  for (size_t ch = 0; ch < size(); ++ch) {
+    std::copy(get_samples(ch), get_samples(ch) + m_sizes[ch], data.data() + ch * stride);
+  }
+  m_data.swap(data);
+  m_stride = stride;
+}
+
+void
+Counter::fill(size_t ch, const uint16_t* adcs, size_t n)
+{
+  n = std::min(n, m_stride - m_sizes[ch]);
+  std::copy(adcs, adcs + n, m_data.data() + ch * m_stride + m_sizes[ch]);
+  m_sizes[ch] += n;
 }
 
 void
 Counter::clean()
 {
-  m_nentries = 0;
-  count.clear();
+  // Only the sizes, the samples are overwritten by the next fills
+  std::fill(m_sizes.begin(), m_sizes.end(), 0);
+}
+
+void
+Counter::set_reduction(RawReduction reduction, size_t points)
+{
+  m_reduction = points > 0 ? reduction : RawReduction::kNone;
+  m_points = points;
+}
+
+size_t
+Counter::get_bucket() const
+{
+  if (m_reduction == RawReduction::kNone) {
+    return 1;
+  }
+  // From the samples that arrived, the rows are padded and can be larger
+  size_t largest = m_sizes.empty() ? 0 : *std::max_element(m_sizes.begin(), m_sizes.end());
+  return get_raw_bucket(largest, m_points);
+}
+
+std::string
+Counter::get_header_fields() const
+{
+  if (m_reduction == RawReduction::kNone) {
+    return "";
+  }
+  return "\"reduction\": \"" + std::string(get_raw_reduction_name(m_reduction)) + "\"," + "\"bucket\": \"" +
+         std::to_string(get_bucket()) + "\"";
+}
+
+void
+Counter::gather(size_t ch, std::vector<uint32_t>& out) const
+{
+  reduce_raw(m_reduction, get_samples(ch), m_sizes[ch], get_bucket(), out);
 }
 
 } // namespace dunedaq
@@ -11,7 +11,10 @@
 // dqm
 
 #include "dqm/algs/Fourier.hpp"
+#include "dqm/algs/FourierPlans.hpp"
+#include "dqm/algs/FourierWindow.hpp"
 
+#include <algorithm>
 #include <complex>
 #include <string>
 #include <valarray>
@@ -22,12 +25,21 @@
 
 namespace dunedaq::dqm {
 
-Fourier::Fourier(double inc, int npoints) // NOLINT(build/unsigned)
+Fourier::Fourier(double inc, int npoints, FourierWindowType window, int nsamples) // NOLINT(build/unsigned)
   : m_inc_size(inc)
   , m_npoints(npoints)
+  , m_nsamples(nsamples > 0 ? std::min(nsamples, npoints) : npoints)
+  , m_window(make_fourier_window(window, m_nsamples))
 {
   m_data.reserve(npoints);
-  m_transform = std::vector<std::complex<double>> (npoints);
+  m_transform.resize(npoints / 2 + 1);
+  m_output.resize(npoints);
+  m_frequencies.reserve(npoints / 2 + 1);
+  for (int i = 0; i <= npoints / 2; ++i) {
+    m_frequencies.push_back(i / (m_inc_size * m_npoints));
+  }
+  // Create the plan now instead of in the first transform
+  FourierPlans::get().get_plan(npoints);
 }
 
 
@@ -35,35 +47,36 @@ Fourier::Fourier(double inc, int npoints) // NOLINT(build/unsigned)
  * @brief Compute the absolute value of the fourier transform
  *        using the FFTW library
  */
-void
+bool
 Fourier::compute_fourier_transform() {
 
-	
-  if (m_data.size() < (size_t)m_npoints) {
+  m_has_transform = false;
+  if (m_data.size() < (size_t)m_nsamples) {
     //m_npoints = m_data.size();
-    ers::info(ParameterChange(ERS_HERE, "Input doesn't have the expected min n_samples for the Fourier transform, " + std::to_string(m_data.size()) + " instead of "+ std::to_string(m_npoints) + ". Skipping this event."));
-    return;
+    ers::info(ParameterChange(ERS_HERE, "Input doesn't have the expected min n_samples for the Fourier transform, " + std::to_string(m_data.size()) + " instead of "+ std::to_string(m_nsamples) + ". Skipping this event."));
+    return false;
   }
 
-//  if (m_transform.size() != (size_t)m_npoints) {
-//    m_transform.resize(m_npoints);
-//  }
-
-  std::vector<double> tmp(m_npoints);
+  // The window and the padding are applied in place, the samples after
+  // m_nsamples are not used
+  for (size_t i = 0; i < m_window.size(); ++i) {
+    m_data[i] *= m_window[i];
+  }
+  if (m_data.size() < (size_t)m_npoints) {
+    m_data.resize(m_npoints, 0);
+  }
+  std::fill(m_data.begin() + m_nsamples, m_data.begin() + m_npoints, 0);
 
-  // A plan is created, executed and destroyed each time_t
-  // Not the most efficient way but using the new-array interface
-  // and creating a single plan that is passed around crashes for
-  // an unknown reason. Anyway in the docs they say that creating a new plan
-  // once another one has been created before for the same size is cheap
-  // FFTW_MEASURE instead of FFTW_ESTIMATE doesn't change the output
-  fftw_plan plan = fftw_plan_r2r_1d(m_npoints, m_data.data(), tmp.data(), FFTW_R2HC, FFTW_ESTIMATE );
+  // The plan is shared with every Fourier object of the same size and
+  // executed on the buffers of this one, which have the alignment it was
+  // created with. fftw_execute_r2r is thread safe
+  fftw_plan plan = FourierPlans::get().get_plan(m_npoints);
   if (plan == NULL) {
     ers::error(CouldNotCreateFourierPlan(ERS_HERE, ""));
-    return;
+    return false;
   }
-  fftw_execute(plan);
-  fftw_destroy_plan(plan);
+  auto& tmp = m_output;
+  fftw_execute_r2r(plan, m_data.data(), tmp.data());
   // After the transform is computed half of the elements of the
   // output array are the real part and the other half are the
   // complex part
@@ -75,13 +88,20 @@ Fourier::compute_fourier_transform() {
   }
   m_transform[0] = {tmp[0], 0};
   m_transform[m_npoints / 2] = {tmp[m_npoints / 2], 0};
-  m_transform.resize(m_npoints / 2 + 1);
+  m_has_transform = true;
+  return true;
 }
 
-
-std::vector<std::complex<double>>
-Fourier::get_transform() {
-  return m_transform;
+void
+Fourier::set_sum(const std::vector<const Fourier*>& others)
+{
+  std::fill(m_transform.begin(), m_transform.end(), 0);
+  for (auto other : others) {
+    for (size_t i = 0; i < m_transform.size(); ++i) {
+      m_transform[i] += other->m_transform[i];
+    }
+  }
+  m_has_transform = true;
 }
 
 /**
@@ -90,7 +110,7 @@ Fourier::get_transform() {
  *        Must be called after compute_fourier_transform
  */
 std::complex<double>
-Fourier::get_transform_at(int index)
+Fourier::get_transform_at(int index) const
 {
   if (index < 0 || static_cast<size_t>(index) >= m_transform.size()) {
     TLOG() << "WARNING: Fourier::get_transform called with index out of range, index=" << index
@@ -100,21 +120,6 @@ Fourier::get_transform_at(int index)
   return m_transform[index];
 }
 
-/**
- * @brief Get the output frequencies (only non-negative frequencies)
- */
-std::vector<double>
-Fourier::get_frequencies()
-{
-  std::vector<double> ret;
-  for (int i = 0; i <= m_npoints / 2; ++i)
-    ret.push_back(i / (m_inc_size * m_npoints));
-  // Don't return the negative frequencies by commenting the following block
-  // for (int i = -m_npoints/2; i < 0; ++i)
-  //   ret.push_back(i / (m_inc_size * m_npoints));
-  return ret;
-}
-
 /**
  * @brief Fill the values that will be used to compute the fourier transform
  *
@@ -126,15 +131,14 @@ Fourier::fill(double value) // NOLINT(build/unsigned)
 }
 
 /**
- * @brief Clear the vectors that hold the data and the fourier transform
- *
- *        This function leaves the Fourier object not usable anymore
+ * @brief Clear the data, the buffers keep their size so that the
+ *        object can be filled again
  */
 void
 Fourier::clean()
 {
   m_data.clear();
-  m_transform.clear();
+  m_has_transform = false;
 }
 
 } // namespace dunedaq::dqm
@@ -0,0 +1,147 @@
+/**
+ * @file FourierBands.cpp Compact representations of the spectra of every channel
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_FOURIERBANDS_CPP_
+#define DQM_SRC_DQM_ALGS_FOURIERBANDS_CPP_
+
+#include "dqm/algs/FourierBands.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+FourierBands::FourierBands(const std::vector<double>& frequencies, std::vector<double> edges)
+{
+  std::sort(edges.begin(), edges.end());
+  size_t k = 0;
+  bool pending = false;
+  double pending_lower = 0;
+  for (size_t b = 0; b + 1 < edges.size(); ++b) {
+    double lower = edges[b];
+    double upper = edges[b + 1];
+    bool last = b + 2 == edges.size();
+    while (k < frequencies.size() && frequencies[k] < lower) {
+      ++k;
+    }
+    size_t first = k;
+    while (k < frequencies.size() && (frequencies[k] < upper || (last && frequencies[k] == upper))) {
+      ++k;
+    }
+    if (first == k) {
+      if (!pending) {
+        pending = true;
+        pending_lower = lower;
+      }
+      continue;
+    }
+    if (m_edges.empty()) {
+      m_edges.push_back(pending ? pending_lower : lower);
+    }
+    pending = false;
+    m_first.push_back(first);
+    m_last.push_back(k);
+    m_edges.push_back(upper);
+  }
+  // Empty bands at the end go to the last one
+  if (!m_edges.empty()) {
+    m_edges.back() = edges.back();
+  }
+}
+
+std::vector<double>
+FourierBands::log_edges(const std::vector<double>& frequencies, int nbands)
+{
+  std::vector<double> edges;
+  if (frequencies.size() < 2 || nbands <= 0) {
+    return edges;
+  }
+  double lowest = frequencies[1];
+  double ratio = std::pow(frequencies.back() / lowest, 1. / nbands);
+  for (int b = 0; b < nbands; ++b) {
+    edges.push_back(lowest * std::pow(ratio, b));
+  }
+  // Exactly the last frequency so that it is included
+  edges.push_back(frequencies.back());
+  return edges;
+}
+
+template<class R>
+void
+FourierBands::reduce(const R* magnitudes, float* out) const
+{
+  for (size_t b = 0; b < m_first.size(); ++b) {
+    double power = 0;
+    for (size_t k = m_first[b]; k < m_last[b]; ++k) {
+      power += static_cast<double>(magnitudes[k]) * magnitudes[k];
+    }
+    out[b] = std::sqrt(power / (m_last[b] - m_first[b]));
+  }
+}
+
+template void FourierBands::reduce<double>(const double*, float*) const;
+template void FourierBands::reduce<float>(const float*, float*) const;
+
+uint16_t
+float_to_half(float value)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  uint16_t sign = (bits >> 16) & 0x8000;
+  uint32_t abs = bits & 0x7fffffff;
+  // Infinity and NaN
+  if (abs >= 0x7f800000) {
+    return sign | 0x7c00 | (abs > 0x7f800000 ? 0x200 : 0);
+  }
+  // 65520 and above round to infinity
+  if (abs >= 0x477ff000) {
+    return sign | 0x7c00;
+  }
+  // Below 2^-14 the result is subnormal, a multiple of 2^-24
+  if (abs < 0x38800000) {
+    float magnitude;
+    std::memcpy(&magnitude, &abs, sizeof(magnitude));
+    return sign | static_cast<uint16_t>(std::nearbyint(magnitude * 16777216.f));
+  }
+  uint32_t half = ((abs >> 23) - 127 + 15) << 10 | (abs & 0x7fffff) >> 13;
+  uint32_t rest = abs & 0x1fff;
+  // A carry from the mantissa goes into the exponent, which is what rounding needs
+  if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+    ++half;
+  }
+  return sign | half;
+}
+
+uint16_t
+float_to_half_saturated(float value)
+{
+  // NaN is kept as it is by min and max
+  constexpr float half_max = 65504;
+  return float_to_half(std::max(std::min(value, half_max), -half_max));
+}
+
+float
+half_to_float(uint16_t value)
+{
+  uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+  uint32_t exponent = (value >> 10) & 0x1f;
+  uint32_t mantissa = value & 0x3ff;
+  float result;
+  if (exponent == 0) {
+    result = std::ldexp(static_cast<float>(mantissa), -24);
+    return sign ? -result : result;
+  }
+  uint32_t bits = sign | (exponent == 0x1f ? 0x7f800000 | mantissa << 13 : (exponent - 15 + 127) << 23 | mantissa << 13);
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_DQM_ALGS_FOURIERBANDS_CPP_
@@ -0,0 +1,142 @@
+/**
+ * @file FourierBatch.cpp Fourier transforms of many channels at once using the fftw3 library
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_FOURIERBATCH_CPP_
+#define DQM_SRC_DQM_ALGS_FOURIERBATCH_CPP_
+
+#include "dqm/algs/FourierBatch.hpp"
+#include "dqm/algs/FourierPlans.hpp"
+#include "dqm/algs/Kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <type_traits>
+#include <vector>
+
+// #include <complex> has to be before this include
+#include <fftw3.h>
+
+namespace dunedaq::dqm {
+
+template<class R>
+FourierBatch<R>::FourierBatch(size_t nchannels, int npoints, double inc, FourierWindowType window, int nsamples)
+  : m_nchannels(nchannels)
+  , m_npoints(npoints)
+  , m_nsamples(nsamples > 0 ? std::min(nsamples, npoints) : npoints)
+  , m_inc_size(inc)
+  , m_input_stride(pad_to_cache_line<R>(npoints))
+  , m_output_stride(pad_to_cache_line<std::complex<R>>(npoints / 2 + 1))
+  , m_input(nchannels * m_input_stride, 0)
+  , m_magnitudes(nchannels * m_output_stride, 0)
+{
+  // The window only covers the samples, not the padding
+  auto values = make_fourier_window(window, m_nsamples);
+  m_window.assign(values.begin(), values.end());
+  m_frequencies.reserve(npoints / 2 + 1);
+  for (int i = 0; i <= npoints / 2; ++i) {
+    m_frequencies.push_back(i / (m_inc_size * m_npoints));
+  }
+  // Create the plans now instead of in the first transform
+  create_plans(nchannels, npoints);
+}
+
+template<class R>
+bool
+FourierBatch<R>::create_plans(size_t nchannels, int npoints)
+{
+  bool ok = get_block_plan(npoints, std::min(nchannels, s_channels_per_block)) != nullptr;
+  if (nchannels % s_channels_per_block) {
+    ok = get_block_plan(npoints, nchannels % s_channels_per_block) != nullptr && ok;
+  }
+  return ok;
+}
+
+template<class R>
+typename FourierBatch<R>::plan_type
+FourierBatch<R>::get_block_plan(int npoints, size_t nchannels)
+{
+  // The same strides as the rows of the batch
+  int input_stride = pad_to_cache_line<R>(npoints);
+  int output_stride = pad_to_cache_line<std::complex<R>>(npoints / 2 + 1);
+  if constexpr (std::is_same_v<R, float>) {
+    return FourierPlans::get().get_many_plan_float(npoints, nchannels, input_stride, output_stride);
+  } else {
+    return FourierPlans::get().get_many_plan(npoints, nchannels, input_stride, output_stride);
+  }
+}
+
+template<class R>
+void
+FourierBatch<R>::fill(size_t ch, const uint16_t* adcs)
+{
+  R* out = row(ch);
+  if (m_window.empty()) {
+    for (int i = 0; i < m_nsamples; ++i) {
+      out[i] = adcs[i];
+    }
+  } else if constexpr (std::is_same_v<R, float>) {
+    get_kernels().window_row_float(adcs, m_window.data(), m_nsamples, out);
+  } else {
+    get_kernels().window_row(adcs, m_window.data(), m_nsamples, out);
+  }
+}
+
+template<class R>
+void
+FourierBatch<R>::clear(size_t ch)
+{
+  std::fill(row(ch), row(ch) + m_nsamples, 0);
+}
+
+template<class R>
+bool
+FourierBatch<R>::compute_block(size_t block)
+{
+  size_t first = block * s_channels_per_block;
+  size_t count = std::min(s_channels_per_block, m_nchannels - first);
+  plan_type plan = get_block_plan(m_npoints, count);
+  if (plan == nullptr) {
+    return false;
+  }
+  // The complex output of a block is only needed until the magnitudes are
+  // taken, so every thread reuses its own buffer
+  thread_local aligned_vector<std::complex<R>> transform;
+  transform.resize(count * m_output_stride);
+  if constexpr (std::is_same_v<R, float>) {
+    fftwf_execute_dft_r2c(plan, row(first), reinterpret_cast<fftwf_complex*>(transform.data())); // NOLINT
+  } else {
+    fftw_execute_dft_r2c(plan, row(first), reinterpret_cast<fftw_complex*>(transform.data())); // NOLINT
+  }
+  size_t nfreq = get_num_frequencies();
+  for (size_t ich = 0; ich < count; ++ich) {
+    const std::complex<R>* in = transform.data() + ich * m_output_stride;
+    R* out = m_magnitudes.data() + (first + ich) * m_output_stride;
+    for (size_t k = 0; k < nfreq; ++k) {
+      out[k] = std::abs(in[k]);
+    }
+  }
+  return true;
+}
+
+template<class R>
+bool
+FourierBatch<R>::compute()
+{
+  bool ok = true;
+  for (size_t block = 0; block < get_num_blocks(); ++block) {
+    ok = compute_block(block) && ok;
+  }
+  return ok;
+}
+
+template class FourierBatch<double>;
+template class FourierBatch<float>;
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_DQM_ALGS_FOURIERBATCH_CPP_
@@ -0,0 +1,194 @@
+/**
+ * @file FourierPlans.cpp Cache of the fftw3 plans shared by all the Fourier objects
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_FOURIERPLANS_CPP_
+#define DQM_SRC_DQM_ALGS_FOURIERPLANS_CPP_
+
+#include "dqm/algs/FourierPlans.hpp"
+#include "dqm/DQMLogging.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <complex>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+// #include <complex> has to be before this include
+#include <fftw3.h>
+
+namespace dunedaq::dqm {
+
+FourierPlans&
+FourierPlans::get()
+{
+  static FourierPlans plans;
+  return plans;
+}
+
+FourierPlans::~FourierPlans()
+{
+  clear();
+}
+
+void
+FourierPlans::set_rigor(unsigned rigor)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_rigor = rigor;
+}
+
+unsigned
+FourierPlans::get_rigor() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_rigor;
+}
+
+fftw_plan
+FourierPlans::get_plan(int npoints)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_plans.find(npoints);
+  if (it != m_plans.end()) {
+    return it->second;
+  }
+
+  // FFTW_MEASURE and FFTW_PATIENT overwrite the arrays while planning so the
+  // plan is made on its own buffers, fftw_malloc gives the same alignment
+  // that the buffers of Fourier have
+  auto in = static_cast<double*>(fftw_malloc(sizeof(double) * npoints));
+  auto out = static_cast<double*>(fftw_malloc(sizeof(double) * npoints));
+  fftw_plan plan = nullptr;
+  if (in && out) {
+    plan = fftw_plan_r2r_1d(npoints, in, out, FFTW_R2HC, m_rigor);
+  }
+  fftw_free(in);
+  fftw_free(out);
+  if (plan == nullptr) {
+    return nullptr;
+  }
+  TLOG_DEBUG(logging::TLVL_WORK_STEPS) << "Created a Fourier plan for " << npoints << " points";
+  m_plans[npoints] = plan;
+  return plan;
+}
+
+fftw_plan
+FourierPlans::get_many_plan(int npoints, int howmany, int input_distance, int output_distance)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto key = std::make_tuple(npoints, howmany, input_distance, output_distance);
+  auto it = m_many_plans.find(key);
+  if (it != m_many_plans.end()) {
+    return it->second;
+  }
+
+  auto in = static_cast<double*>(fftw_malloc(sizeof(double) * input_distance * howmany));
+  auto out = static_cast<fftw_complex*>(fftw_malloc(sizeof(fftw_complex) * output_distance * howmany));
+  fftw_plan plan = nullptr;
+  if (in && out) {
+    plan = fftw_plan_many_dft_r2c(1, &npoints, howmany,
+                                  in, nullptr, 1, input_distance,
+                                  out, nullptr, 1, output_distance,
+                                  m_rigor);
+  }
+  fftw_free(in);
+  fftw_free(out);
+  if (plan == nullptr) {
+    return nullptr;
+  }
+  TLOG_DEBUG(logging::TLVL_WORK_STEPS) << "Created a Fourier plan for " << howmany << " transforms of " << npoints << " points";
+  m_many_plans[key] = plan;
+  return plan;
+}
+
+fftwf_plan
+FourierPlans::get_many_plan_float(int npoints, int howmany, int input_distance, int output_distance)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto key = std::make_tuple(npoints, howmany, input_distance, output_distance);
+  auto it = m_many_plans_float.find(key);
+  if (it != m_many_plans_float.end()) {
+    return it->second;
+  }
+
+  auto in = static_cast<float*>(fftwf_malloc(sizeof(float) * input_distance * howmany));
+  auto out = static_cast<fftwf_complex*>(fftwf_malloc(sizeof(fftwf_complex) * output_distance * howmany));
+  fftwf_plan plan = nullptr;
+  if (in && out) {
+    plan = fftwf_plan_many_dft_r2c(1, &npoints, howmany,
+                                   in, nullptr, 1, input_distance,
+                                   out, nullptr, 1, output_distance,
+                                   m_rigor);
+  }
+  fftwf_free(in);
+  fftwf_free(out);
+  if (plan == nullptr) {
+    return nullptr;
+  }
+  TLOG_DEBUG(logging::TLVL_WORK_STEPS) << "Created a single precision Fourier plan for " << howmany << " transforms of "
+                                       << npoints << " points";
+  m_many_plans_float[key] = plan;
+  return plan;
+}
+
+bool
+FourierPlans::load_wisdom(const std::string& filename)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  // There may be no single precision wisdom yet
+  fftwf_import_wisdom_from_filename((filename + ".float").c_str());
+  return fftw_import_wisdom_from_filename(filename.c_str());
+}
+
+bool
+FourierPlans::save_wisdom(const std::string& filename)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  bool saved = fftw_export_wisdom_to_filename(filename.c_str());
+  if (!m_many_plans_float.empty()) {
+    saved = fftwf_export_wisdom_to_filename((filename + ".float").c_str()) && saved;
+  }
+  return saved;
+}
+
+void
+FourierPlans::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& [npoints, plan] : m_plans) {
+    fftw_destroy_plan(plan);
+  }
+  m_plans.clear();
+  for (auto& [key, plan] : m_many_plans) {
+    fftw_destroy_plan(plan);
+  }
+  m_many_plans.clear();
+  for (auto& [key, plan] : m_many_plans_float) {
+    fftwf_destroy_plan(plan);
+  }
+  m_many_plans_float.clear();
+}
+
+std::optional<unsigned>
+parse_fourier_rigor(const std::string& name)
+{
+  if (name == "estimate") {
+    return FFTW_ESTIMATE;
+  }
+  if (name == "measure") {
+    return FFTW_MEASURE;
+  }
+  if (name == "patient") {
+    return FFTW_PATIENT;
+  }
+  return std::nullopt;
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_DQM_ALGS_FOURIERPLANS_CPP_
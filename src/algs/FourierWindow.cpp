@@ -0,0 +1,116 @@
+/**
+ * @file FourierWindow.cpp Window functions and lengths for the Fourier transforms
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_FOURIERWINDOW_CPP_
+#define DQM_SRC_DQM_ALGS_FOURIERWINDOW_CPP_
+
+#include "dqm/algs/FourierWindow.hpp"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace dunedaq::dqm {
+
+std::vector<double>
+make_fourier_window(FourierWindowType type, int n)
+{
+  std::vector<double> window;
+  if (type == FourierWindowType::kNone) {
+    return window;
+  }
+  window.resize(n);
+  for (int i = 0; i < n; ++i) {
+    double x = 2 * M_PI * i / n;
+    switch (type) {
+      case FourierWindowType::kHann:
+        window[i] = 0.5 - 0.5 * std::cos(x);
+        break;
+      case FourierWindowType::kHamming:
+        window[i] = 0.54 - 0.46 * std::cos(x);
+        break;
+      case FourierWindowType::kBlackman:
+        window[i] = 0.42 - 0.5 * std::cos(x) + 0.08 * std::cos(2 * x);
+        break;
+      default:
+        window[i] = 1;
+    }
+  }
+  return window;
+}
+
+std::optional<FourierWindowType>
+parse_fourier_window(const std::string& name)
+{
+  if (name == "none") {
+    return FourierWindowType::kNone;
+  }
+  if (name == "hann") {
+    return FourierWindowType::kHann;
+  }
+  if (name == "hamming") {
+    return FourierWindowType::kHamming;
+  }
+  if (name == "blackman") {
+    return FourierWindowType::kBlackman;
+  }
+  return std::nullopt;
+}
+
+std::optional<FourierLength>
+parse_fourier_length(const std::string& name)
+{
+  if (name == "exact") {
+    return FourierLength::kExact;
+  }
+  if (name == "down") {
+    return FourierLength::kRoundDown;
+  }
+  if (name == "up") {
+    return FourierLength::kPadUp;
+  }
+  return std::nullopt;
+}
+
+bool
+is_fast_fourier_length(int n)
+{
+  if (n <= 0) {
+    return false;
+  }
+  for (int factor : { 2, 3, 5 }) {
+    while (n % factor == 0) {
+      n /= factor;
+    }
+  }
+  return n == 1;
+}
+
+int
+get_fourier_length(int nsamples, FourierLength length)
+{
+  if (nsamples <= 1 || length == FourierLength::kExact) {
+    return nsamples;
+  }
+  // Fast sizes are dense enough (the gaps are a few percent of n) that
+  // walking to the closest one is cheap
+  int n = nsamples;
+  if (length == FourierLength::kRoundDown) {
+    while (!is_fast_fourier_length(n)) {
+      --n;
+    }
+  } else {
+    while (!is_fast_fourier_length(n)) {
+      ++n;
+    }
+  }
+  return n;
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_DQM_ALGS_FOURIERWINDOW_CPP_
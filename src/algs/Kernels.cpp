@@ -0,0 +1,612 @@
+/**
+ * @file Kernels.cpp Vectorized statistics, plane sum and window kernels and their runtime selection
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_KERNELS_CPP_
+#define DQM_SRC_DQM_ALGS_KERNELS_CPP_
+
+#include "dqm/algs/Kernels.hpp"
+#include "dqm/algs/Unpack.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+#include <immintrin.h>
+
+namespace dunedaq::dqm {
+
+namespace {
+
+void
+sum_row_scalar(const uint16_t* adcs, size_t n, uint64_t& sum, uint64_t& sum_sq)
+{
+  uint64_t s = 0, sq = 0;
+  for (size_t i = 0; i < n; ++i) {
+    s += adcs[i];
+    sq += static_cast<uint64_t>(adcs[i]) * adcs[i];
+  }
+  sum += s;
+  sum_sq += sq;
+}
+
+void
+add_row_scalar(const uint16_t* adcs, size_t n, double* acc)
+{
+  for (size_t i = 0; i < n; ++i) {
+    acc[i] += adcs[i];
+  }
+}
+
+template<class R>
+void
+window_row_scalar(const uint16_t* adcs, const R* window, size_t n, R* out)
+{
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = adcs[i] * window[i];
+  }
+}
+
+void
+summarize_row_scalar(const uint16_t* adcs, size_t n, uint16_t full_scale, RowSummary& summary)
+{
+  uint64_t s = 0, sq = 0, zeros = 0, saturated = 0;
+  uint16_t lo = summary.min, hi = summary.max;
+  for (size_t i = 0; i < n; ++i) {
+    uint16_t adc = adcs[i];
+    s += adc;
+    sq += static_cast<uint64_t>(adc) * adc;
+    lo = std::min(lo, adc);
+    hi = std::max(hi, adc);
+    zeros += adc == 0;
+    saturated += adc == full_scale;
+  }
+  summary.sum += s;
+  summary.sum_sq += sq;
+  summary.min = lo;
+  summary.max = hi;
+  summary.zeros += zeros;
+  summary.saturated += saturated;
+}
+
+void
+min_max_scalar(const uint16_t* adcs, size_t n, uint16_t& lo, uint16_t& hi)
+{
+  for (size_t i = 0; i < n; ++i) {
+    lo = std::min(lo, adcs[i]);
+    hi = std::max(hi, adcs[i]);
+  }
+}
+
+void
+envelope_row_scalar(const uint16_t* adcs, size_t n, size_t bucket, uint16_t* out)
+{
+  for (size_t first = 0; first < n; first += bucket, out += 2) {
+    uint16_t lo = UINT16_MAX, hi = 0;
+    min_max_scalar(adcs + first, std::min(bucket, n - first), lo, hi);
+    out[0] = lo;
+    out[1] = hi;
+  }
+}
+
+// The sums use madd, which multiplies signed 16-bit integers and adds pairs
+// of products into 32-bit integers. Since the values are below 2^15 the
+// products and the pair sums fit and they are widened to 64 bits right away
+
+__attribute__((target("sse4.2"))) void
+sum_row_sse42(const uint16_t* adcs, size_t n, uint64_t& sum, uint64_t& sum_sq)
+{
+  const __m128i ones = _mm_set1_epi16(1);
+  __m128i acc_sum = _mm_setzero_si128();
+  __m128i acc_sq = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(adcs + i)); // NOLINT
+    __m128i s = _mm_madd_epi16(x, ones);
+    __m128i sq = _mm_madd_epi16(x, x);
+    acc_sum = _mm_add_epi64(acc_sum, _mm_cvtepu32_epi64(s));
+    acc_sum = _mm_add_epi64(acc_sum, _mm_cvtepu32_epi64(_mm_srli_si128(s, 8)));
+    acc_sq = _mm_add_epi64(acc_sq, _mm_cvtepu32_epi64(sq));
+    acc_sq = _mm_add_epi64(acc_sq, _mm_cvtepu32_epi64(_mm_srli_si128(sq, 8)));
+  }
+  sum += _mm_extract_epi64(acc_sum, 0) + _mm_extract_epi64(acc_sum, 1);
+  sum_sq += _mm_extract_epi64(acc_sq, 0) + _mm_extract_epi64(acc_sq, 1);
+  sum_row_scalar(adcs + i, n - i, sum, sum_sq);
+}
+
+__attribute__((target("sse4.2"))) void
+add_row_sse42(const uint16_t* adcs, size_t n, double* acc)
+{
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(adcs + i))); // NOLINT
+    _mm_storeu_pd(acc + i, _mm_add_pd(_mm_loadu_pd(acc + i), _mm_cvtepi32_pd(x)));
+    _mm_storeu_pd(acc + i + 2, _mm_add_pd(_mm_loadu_pd(acc + i + 2), _mm_cvtepi32_pd(_mm_srli_si128(x, 8))));
+  }
+  add_row_scalar(adcs + i, n - i, acc + i);
+}
+
+__attribute__((target("sse4.2"))) void
+window_row_sse42(const uint16_t* adcs, const double* window, size_t n, double* out)
+{
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(adcs + i))); // NOLINT
+    _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(window + i), _mm_cvtepi32_pd(x)));
+    _mm_storeu_pd(out + i + 2, _mm_mul_pd(_mm_loadu_pd(window + i + 2), _mm_cvtepi32_pd(_mm_srli_si128(x, 8))));
+  }
+  window_row_scalar(adcs + i, window + i, n - i, out + i);
+}
+
+__attribute__((target("sse4.2"))) void
+window_row_float_sse42(const uint16_t* adcs, const float* window, size_t n, float* out)
+{
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(adcs + i))); // NOLINT
+    _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(window + i), _mm_cvtepi32_ps(x)));
+  }
+  window_row_scalar(adcs + i, window + i, n - i, out + i);
+}
+
+// The counts of zeros and saturated values are kept as negative 16-bit
+// lane counters (compare gives -1) that are flushed before they can overflow
+
+__attribute__((target("sse4.2"))) void
+summarize_row_sse42(const uint16_t* adcs, size_t n, uint16_t full_scale, RowSummary& summary)
+{
+  const __m128i ones = _mm_set1_epi16(1);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i full = _mm_set1_epi16(full_scale);
+  __m128i acc_sum = _mm_setzero_si128();
+  __m128i acc_sq = _mm_setzero_si128();
+  __m128i lo = _mm_set1_epi16(-1);
+  __m128i hi = _mm_setzero_si128();
+  uint64_t zeros = 0, saturated = 0;
+  size_t i = 0;
+  while (i + 8 <= n) {
+    __m128i cnt_zero = _mm_setzero_si128();
+    __m128i cnt_full = _mm_setzero_si128();
+    size_t end = std::min(n - n % 8, i + 8 * 32767);
+    for (; i < end; i += 8) {
+      __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(adcs + i)); // NOLINT
+      __m128i s = _mm_madd_epi16(x, ones);
+      __m128i sq = _mm_madd_epi16(x, x);
+      acc_sum = _mm_add_epi64(acc_sum, _mm_cvtepu32_epi64(s));
+      acc_sum = _mm_add_epi64(acc_sum, _mm_cvtepu32_epi64(_mm_srli_si128(s, 8)));
+      acc_sq = _mm_add_epi64(acc_sq, _mm_cvtepu32_epi64(sq));
+      acc_sq = _mm_add_epi64(acc_sq, _mm_cvtepu32_epi64(_mm_srli_si128(sq, 8)));
+      lo = _mm_min_epu16(lo, x);
+      hi = _mm_max_epu16(hi, x);
+      cnt_zero = _mm_sub_epi16(cnt_zero, _mm_cmpeq_epi16(x, zero));
+      cnt_full = _mm_sub_epi16(cnt_full, _mm_cmpeq_epi16(x, full));
+    }
+    __m128i z = _mm_madd_epi16(cnt_zero, ones);
+    __m128i f = _mm_madd_epi16(cnt_full, ones);
+    zeros += static_cast<uint32_t>(_mm_extract_epi32(z, 0)) + static_cast<uint32_t>(_mm_extract_epi32(z, 1)) +
+             static_cast<uint32_t>(_mm_extract_epi32(z, 2)) + static_cast<uint32_t>(_mm_extract_epi32(z, 3));
+    saturated += static_cast<uint32_t>(_mm_extract_epi32(f, 0)) + static_cast<uint32_t>(_mm_extract_epi32(f, 1)) +
+                 static_cast<uint32_t>(_mm_extract_epi32(f, 2)) + static_cast<uint32_t>(_mm_extract_epi32(f, 3));
+  }
+  summary.sum += _mm_extract_epi64(acc_sum, 0) + _mm_extract_epi64(acc_sum, 1);
+  summary.sum_sq += _mm_extract_epi64(acc_sq, 0) + _mm_extract_epi64(acc_sq, 1);
+  summary.zeros += zeros;
+  summary.saturated += saturated;
+  // minpos gives the minimum of 8 unsigned 16-bit values, the maximum is the minimum of the complement
+  if (n >= 8) {
+    summary.min = std::min<uint16_t>(summary.min, _mm_extract_epi16(_mm_minpos_epu16(lo), 0));
+    summary.max = std::max<uint16_t>(summary.max, ~_mm_extract_epi16(_mm_minpos_epu16(_mm_xor_si128(hi, _mm_set1_epi16(-1))), 0));
+  }
+  summarize_row_scalar(adcs + i, n - i, full_scale, summary);
+}
+
+// The minimum of each bucket is reduced with minpos, and the maximum is the
+// minimum of the complement
+
+__attribute__((target("sse4.2"))) void
+reduce_min_max_sse42(__m128i lo, __m128i hi, uint16_t& min, uint16_t& max)
+{
+  min = std::min<uint16_t>(min, _mm_extract_epi16(_mm_minpos_epu16(lo), 0));
+  max = std::max<uint16_t>(max, ~_mm_extract_epi16(_mm_minpos_epu16(_mm_xor_si128(hi, _mm_set1_epi16(-1))), 0));
+}
+
+__attribute__((target("sse4.2"))) void
+envelope_row_sse42(const uint16_t* adcs, size_t n, size_t bucket, uint16_t* out)
+{
+  for (size_t first = 0; first < n; first += bucket, out += 2) {
+    const uint16_t* x = adcs + first;
+    size_t count = std::min(bucket, n - first);
+    uint16_t min = UINT16_MAX, max = 0;
+    size_t i = 0;
+    if (count >= 8) {
+      __m128i lo = _mm_set1_epi16(-1);
+      __m128i hi = _mm_setzero_si128();
+      for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)); // NOLINT
+        lo = _mm_min_epu16(lo, v);
+        hi = _mm_max_epu16(hi, v);
+      }
+      reduce_min_max_sse42(lo, hi, min, max);
+    }
+    min_max_scalar(x + i, count - i, min, max);
+    out[0] = min;
+    out[1] = max;
+  }
+}
+
+__attribute__((target("avx2"))) void
+sum_row_avx2(const uint16_t* adcs, size_t n, uint64_t& sum, uint64_t& sum_sq)
+{
+  const __m256i ones = _mm256_set1_epi16(1);
+  __m256i acc_sum = _mm256_setzero_si256();
+  __m256i acc_sq = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(adcs + i)); // NOLINT
+    __m256i s = _mm256_madd_epi16(x, ones);
+    __m256i sq = _mm256_madd_epi16(x, x);
+    acc_sum = _mm256_add_epi64(acc_sum, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(s)));
+    acc_sum = _mm256_add_epi64(acc_sum, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(s, 1)));
+    acc_sq = _mm256_add_epi64(acc_sq, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(sq)));
+    acc_sq = _mm256_add_epi64(acc_sq, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(sq, 1)));
+  }
+  alignas(32) uint64_t lanes[4];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc_sum); // NOLINT
+  sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc_sq); // NOLINT
+  sum_sq += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  sum_row_scalar(adcs + i, n - i, sum, sum_sq);
+}
+
+__attribute__((target("avx2"))) void
+add_row_avx2(const uint16_t* adcs, size_t n, double* acc)
+{
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(adcs + i))); // NOLINT
+    _mm256_storeu_pd(acc + i, _mm256_add_pd(_mm256_loadu_pd(acc + i), _mm256_cvtepi32_pd(_mm256_castsi256_si128(x))));
+    _mm256_storeu_pd(acc + i + 4,
+                     _mm256_add_pd(_mm256_loadu_pd(acc + i + 4), _mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1))));
+  }
+  add_row_scalar(adcs + i, n - i, acc + i);
+}
+
+__attribute__((target("avx2"))) void
+window_row_avx2(const uint16_t* adcs, const double* window, size_t n, double* out)
+{
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(adcs + i))); // NOLINT
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(window + i), _mm256_cvtepi32_pd(_mm256_castsi256_si128(x))));
+    _mm256_storeu_pd(out + i + 4,
+                     _mm256_mul_pd(_mm256_loadu_pd(window + i + 4), _mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1))));
+  }
+  window_row_scalar(adcs + i, window + i, n - i, out + i);
+}
+
+__attribute__((target("avx2"))) void
+window_row_float_avx2(const uint16_t* adcs, const float* window, size_t n, float* out)
+{
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(adcs + i))); // NOLINT
+    _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(window + i), _mm256_cvtepi32_ps(x)));
+  }
+  window_row_scalar(adcs + i, window + i, n - i, out + i);
+}
+
+__attribute__((target("avx2"))) void
+summarize_row_avx2(const uint16_t* adcs, size_t n, uint16_t full_scale, RowSummary& summary)
+{
+  const __m256i ones = _mm256_set1_epi16(1);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i full = _mm256_set1_epi16(full_scale);
+  __m256i acc_sum = _mm256_setzero_si256();
+  __m256i acc_sq = _mm256_setzero_si256();
+  __m256i lo = _mm256_set1_epi16(-1);
+  __m256i hi = _mm256_setzero_si256();
+  uint64_t zeros = 0, saturated = 0;
+  alignas(32) uint64_t lanes[4];
+  alignas(32) uint32_t counts[8];
+  size_t i = 0;
+  while (i + 16 <= n) {
+    __m256i cnt_zero = _mm256_setzero_si256();
+    __m256i cnt_full = _mm256_setzero_si256();
+    size_t end = std::min(n - n % 16, i + 16 * 32767);
+    for (; i < end; i += 16) {
+      __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(adcs + i)); // NOLINT
+      __m256i s = _mm256_madd_epi16(x, ones);
+      __m256i sq = _mm256_madd_epi16(x, x);
+      acc_sum = _mm256_add_epi64(acc_sum, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(s)));
+      acc_sum = _mm256_add_epi64(acc_sum, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(s, 1)));
+      acc_sq = _mm256_add_epi64(acc_sq, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(sq)));
+      acc_sq = _mm256_add_epi64(acc_sq, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(sq, 1)));
+      lo = _mm256_min_epu16(lo, x);
+      hi = _mm256_max_epu16(hi, x);
+      cnt_zero = _mm256_sub_epi16(cnt_zero, _mm256_cmpeq_epi16(x, zero));
+      cnt_full = _mm256_sub_epi16(cnt_full, _mm256_cmpeq_epi16(x, full));
+    }
+    _mm256_store_si256(reinterpret_cast<__m256i*>(counts), _mm256_madd_epi16(cnt_zero, ones)); // NOLINT
+    for (auto c : counts) {
+      zeros += c;
+    }
+    _mm256_store_si256(reinterpret_cast<__m256i*>(counts), _mm256_madd_epi16(cnt_full, ones)); // NOLINT
+    for (auto c : counts) {
+      saturated += c;
+    }
+  }
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc_sum); // NOLINT
+  summary.sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc_sq); // NOLINT
+  summary.sum_sq += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  summary.zeros += zeros;
+  summary.saturated += saturated;
+  if (n >= 16) {
+    __m128i lo128 = _mm_min_epu16(_mm256_castsi256_si128(lo), _mm256_extracti128_si256(lo, 1));
+    __m128i hi128 = _mm_max_epu16(_mm256_castsi256_si128(hi), _mm256_extracti128_si256(hi, 1));
+    summary.min = std::min<uint16_t>(summary.min, _mm_extract_epi16(_mm_minpos_epu16(lo128), 0));
+    summary.max = std::max<uint16_t>(summary.max, ~_mm_extract_epi16(_mm_minpos_epu16(_mm_xor_si128(hi128, _mm_set1_epi16(-1))), 0));
+  }
+  summarize_row_scalar(adcs + i, n - i, full_scale, summary);
+}
+
+__attribute__((target("avx2"))) void
+envelope_row_avx2(const uint16_t* adcs, size_t n, size_t bucket, uint16_t* out)
+{
+  for (size_t first = 0; first < n; first += bucket, out += 2) {
+    const uint16_t* x = adcs + first;
+    size_t count = std::min(bucket, n - first);
+    uint16_t min = UINT16_MAX, max = 0;
+    size_t i = 0;
+    if (count >= 16) {
+      __m256i lo = _mm256_set1_epi16(-1);
+      __m256i hi = _mm256_setzero_si256();
+      for (; i + 16 <= count; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)); // NOLINT
+        lo = _mm256_min_epu16(lo, v);
+        hi = _mm256_max_epu16(hi, v);
+      }
+      reduce_min_max_sse42(_mm_min_epu16(_mm256_castsi256_si128(lo), _mm256_extracti128_si256(lo, 1)),
+                           _mm_max_epu16(_mm256_castsi256_si128(hi), _mm256_extracti128_si256(hi, 1)), min, max);
+    }
+    min_max_scalar(x + i, count - i, min, max);
+    out[0] = min;
+    out[1] = max;
+  }
+}
+
+// GCC 12 reports the undefined first operands used inside avx512fintrin.h as
+// uninitialized once the intrinsics are inlined
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f,avx512bw"))) void
+sum_row_avx512(const uint16_t* adcs, size_t n, uint64_t& sum, uint64_t& sum_sq)
+{
+  const __m512i ones = _mm512_set1_epi16(1);
+  __m512i acc_sum = _mm512_setzero_si512();
+  __m512i acc_sq = _mm512_setzero_si512();
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m512i x = _mm512_loadu_si512(adcs + i);
+    __m512i s = _mm512_madd_epi16(x, ones);
+    __m512i sq = _mm512_madd_epi16(x, x);
+    acc_sum = _mm512_add_epi64(acc_sum, _mm512_cvtepu32_epi64(_mm512_castsi512_si256(s)));
+    acc_sum = _mm512_add_epi64(acc_sum, _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(s, 1)));
+    acc_sq = _mm512_add_epi64(acc_sq, _mm512_cvtepu32_epi64(_mm512_castsi512_si256(sq)));
+    acc_sq = _mm512_add_epi64(acc_sq, _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(sq, 1)));
+  }
+  sum += _mm512_reduce_add_epi64(acc_sum);
+  sum_sq += _mm512_reduce_add_epi64(acc_sq);
+  sum_row_scalar(adcs + i, n - i, sum, sum_sq);
+}
+
+__attribute__((target("avx512f,avx512bw"))) void
+add_row_avx512(const uint16_t* adcs, size_t n, double* acc)
+{
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512i x = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(adcs + i))); // NOLINT
+    _mm512_storeu_pd(acc + i, _mm512_add_pd(_mm512_loadu_pd(acc + i), _mm512_cvtepi32_pd(_mm512_castsi512_si256(x))));
+    _mm512_storeu_pd(acc + i + 8,
+                     _mm512_add_pd(_mm512_loadu_pd(acc + i + 8), _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(x, 1))));
+  }
+  add_row_scalar(adcs + i, n - i, acc + i);
+}
+
+__attribute__((target("avx512f,avx512bw"))) void
+window_row_avx512(const uint16_t* adcs, const double* window, size_t n, double* out)
+{
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512i x = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(adcs + i))); // NOLINT
+    _mm512_storeu_pd(out + i,
+                     _mm512_mul_pd(_mm512_loadu_pd(window + i), _mm512_cvtepi32_pd(_mm512_castsi512_si256(x))));
+    _mm512_storeu_pd(out + i + 8,
+                     _mm512_mul_pd(_mm512_loadu_pd(window + i + 8), _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(x, 1))));
+  }
+  window_row_scalar(adcs + i, window + i, n - i, out + i);
+}
+
+__attribute__((target("avx512f,avx512bw"))) void
+window_row_float_avx512(const uint16_t* adcs, const float* window, size_t n, float* out)
+{
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m512i x = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(adcs + i))); // NOLINT
+    _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_loadu_ps(window + i), _mm512_cvtepi32_ps(x)));
+  }
+  window_row_scalar(adcs + i, window + i, n - i, out + i);
+}
+
+__attribute__((target("avx512f,avx512bw"))) void
+summarize_row_avx512(const uint16_t* adcs, size_t n, uint16_t full_scale, RowSummary& summary)
+{
+  const __m512i ones = _mm512_set1_epi16(1);
+  const __m512i full = _mm512_set1_epi16(full_scale);
+  __m512i acc_sum = _mm512_setzero_si512();
+  __m512i acc_sq = _mm512_setzero_si512();
+  __m512i lo = _mm512_set1_epi16(-1);
+  __m512i hi = _mm512_setzero_si512();
+  uint64_t zeros = 0, saturated = 0;
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m512i x = _mm512_loadu_si512(adcs + i);
+    __m512i s = _mm512_madd_epi16(x, ones);
+    __m512i sq = _mm512_madd_epi16(x, x);
+    acc_sum = _mm512_add_epi64(acc_sum, _mm512_cvtepu32_epi64(_mm512_castsi512_si256(s)));
+    acc_sum = _mm512_add_epi64(acc_sum, _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(s, 1)));
+    acc_sq = _mm512_add_epi64(acc_sq, _mm512_cvtepu32_epi64(_mm512_castsi512_si256(sq)));
+    acc_sq = _mm512_add_epi64(acc_sq, _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(sq, 1)));
+    lo = _mm512_min_epu16(lo, x);
+    hi = _mm512_max_epu16(hi, x);
+    // Comparisons give bit masks so the counts are just popcounts
+    zeros += __builtin_popcount(_mm512_testn_epi16_mask(x, x));
+    saturated += __builtin_popcount(_mm512_cmpeq_epi16_mask(x, full));
+  }
+  summary.sum += _mm512_reduce_add_epi64(acc_sum);
+  summary.sum_sq += _mm512_reduce_add_epi64(acc_sq);
+  summary.zeros += zeros;
+  summary.saturated += saturated;
+  if (n >= 32) {
+    alignas(64) uint16_t values[32];
+    _mm512_store_si512(values, lo);
+    summary.min = std::min(summary.min, *std::min_element(values, values + 32));
+    _mm512_store_si512(values, hi);
+    summary.max = std::max(summary.max, *std::max_element(values, values + 32));
+  }
+  summarize_row_scalar(adcs + i, n - i, full_scale, summary);
+}
+
+__attribute__((target("avx512f,avx512bw"))) void
+envelope_row_avx512(const uint16_t* adcs, size_t n, size_t bucket, uint16_t* out)
+{
+  for (size_t first = 0; first < n; first += bucket, out += 2) {
+    const uint16_t* x = adcs + first;
+    size_t count = std::min(bucket, n - first);
+    uint16_t min = UINT16_MAX, max = 0;
+    size_t i = 0;
+    if (count >= 32) {
+      __m512i lo = _mm512_set1_epi16(-1);
+      __m512i hi = _mm512_setzero_si512();
+      for (; i + 32 <= count; i += 32) {
+        __m512i v = _mm512_loadu_si512(x + i);
+        lo = _mm512_min_epu16(lo, v);
+        hi = _mm512_max_epu16(hi, v);
+      }
+      __m256i lo256 = _mm256_min_epu16(_mm512_castsi512_si256(lo), _mm512_extracti64x4_epi64(lo, 1));
+      __m256i hi256 = _mm256_max_epu16(_mm512_castsi512_si256(hi), _mm512_extracti64x4_epi64(hi, 1));
+      reduce_min_max_sse42(_mm_min_epu16(_mm256_castsi256_si128(lo256), _mm256_extracti128_si256(lo256, 1)),
+                           _mm_max_epu16(_mm256_castsi256_si128(hi256), _mm256_extracti128_si256(hi256, 1)), min, max);
+    }
+    min_max_scalar(x + i, count - i, min, max);
+    out[0] = min;
+    out[1] = max;
+  }
+}
+
+#pragma GCC diagnostic pop
+
+const Kernels s_scalar_kernels{ KernelISA::kScalar, unpack_wib2_scalar, sum_row_scalar, add_row_scalar,
+                                summarize_row_scalar, window_row_scalar<double>, window_row_scalar<float>,
+                                envelope_row_scalar };
+const Kernels s_sse42_kernels{ KernelISA::kSSE42, unpack_wib2_sse42, sum_row_sse42, add_row_sse42,
+                               summarize_row_sse42, window_row_sse42, window_row_float_sse42,
+                               envelope_row_sse42 };
+const Kernels s_avx2_kernels{ KernelISA::kAVX2, unpack_wib2_avx2, sum_row_avx2, add_row_avx2,
+                              summarize_row_avx2, window_row_avx2, window_row_float_avx2,
+                              envelope_row_avx2 };
+const Kernels s_avx512_kernels{ KernelISA::kAVX512, unpack_wib2_avx512, sum_row_avx512, add_row_avx512,
+                                summarize_row_avx512, window_row_avx512, window_row_float_avx512,
+                                envelope_row_avx512 };
+
+std::atomic<const Kernels*> s_kernels{ nullptr };
+
+} // namespace
+
+KernelISA
+detect_isa()
+{
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+    return KernelISA::kAVX512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return KernelISA::kAVX2;
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return KernelISA::kSSE42;
+  }
+  return KernelISA::kScalar;
+}
+
+const Kernels&
+get_kernels(KernelISA isa)
+{
+  switch (isa) {
+    case KernelISA::kAVX512:
+      return s_avx512_kernels;
+    case KernelISA::kAVX2:
+      return s_avx2_kernels;
+    case KernelISA::kSSE42:
+      return s_sse42_kernels;
+    default:
+      return s_scalar_kernels;
+  }
+}
+
+KernelISA
+select_kernels(KernelISA max_isa)
+{
+  auto isa = std::min(detect_isa(), max_isa);
+  s_kernels.store(&get_kernels(isa));
+  return isa;
+}
+
+const Kernels&
+get_kernels()
+{
+  auto kernels = s_kernels.load();
+  if (kernels == nullptr) {
+    select_kernels();
+    kernels = s_kernels.load();
+  }
+  return *kernels;
+}
+
+std::string
+get_isa_name(KernelISA isa)
+{
+  switch (isa) {
+    case KernelISA::kAVX512:
+      return "avx512";
+    case KernelISA::kAVX2:
+      return "avx2";
+    case KernelISA::kSSE42:
+      return "sse4.2";
+    default:
+      return "scalar";
+  }
+}
+
+std::optional<KernelISA>
+parse_isa_name(const std::string& name)
+{
+  if (name == "auto") {
+    return KernelISA::kAVX512;
+  }
+  for (auto isa : { KernelISA::kScalar, KernelISA::kSSE42, KernelISA::kAVX2, KernelISA::kAVX512 }) {
+    if (name == get_isa_name(isa)) {
+      return isa;
+    }
+  }
+  return std::nullopt;
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_DQM_ALGS_KERNELS_CPP_
@@ -0,0 +1,83 @@
+/**
+ * @file Mean.cpp Mean and moving pedestal of the ADC values of many channels
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_MEAN_CPP_
+#define DQM_SRC_DQM_ALGS_MEAN_CPP_
+
+#include "dqm/algs/Mean.hpp"
+#include "dqm/algs/Kernels.hpp"
+
+#include <algorithm>
+
+namespace dunedaq::dqm {
+
+Mean::Mean(size_t nchannels, double alpha)
+  : m_alpha(std::clamp(alpha, 0., 1.))
+  , m_counts(nchannels, 0)
+  , m_sums(nchannels, 0)
+  , m_pedestals(nchannels, -1)
+  , m_references(nchannels, -1)
+{
+}
+
+void
+Mean::fill(size_t ch, const uint16_t* adcs, size_t n)
+{
+  if (n == 0) {
+    return;
+  }
+  // The kernel also gives the sum of squares, it is not needed here
+  uint64_t sum = 0, sum_sq = 0;
+  get_kernels().sum_row(adcs, n, sum, sum_sq);
+  m_counts[ch] += n;
+  m_sums[ch] += sum;
+
+  double record_mean = static_cast<double>(sum) / n;
+  if (m_references[ch] < 0) {
+    m_pedestals[ch] = record_mean;
+    m_references[ch] = record_mean;
+  } else {
+    m_pedestals[ch] += m_alpha * (record_mean - m_pedestals[ch]);
+  }
+}
+
+void
+Mean::clean()
+{
+  std::fill(m_counts.begin(), m_counts.end(), 0);
+  std::fill(m_sums.begin(), m_sums.end(), 0);
+}
+
+void
+Mean::reset()
+{
+  clean();
+  std::fill(m_pedestals.begin(), m_pedestals.end(), -1);
+  std::fill(m_references.begin(), m_references.end(), -1);
+}
+
+double
+Mean::mean(size_t ch) const
+{
+  if (not m_counts[ch]) {
+    return -1;
+  }
+  return static_cast<double>(m_sums[ch]) / m_counts[ch];
+}
+
+double
+Mean::drift(size_t ch) const
+{
+  if (m_references[ch] < 0) {
+    return 0;
+  }
+  return m_pedestals[ch] - m_references[ch];
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_DQM_ALGS_MEAN_CPP_
@@ -0,0 +1,144 @@
+/**
+ * @file PlanePower.cpp Power spectrum averaged over the channels of each plane
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_PLANEPOWER_CPP_
+#define DQM_SRC_DQM_ALGS_PLANEPOWER_CPP_
+
+#include "dqm/algs/PlanePower.hpp"
+#include "dqm/algs/FourierPlans.hpp"
+#include "dqm/algs/Kernels.hpp"
+
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+// #include <complex> has to be before this include
+#include <fftw3.h>
+
+namespace dunedaq::dqm {
+
+PlanePower::PlanePower(size_t ngroups, int npoints, double inc, FourierWindowType window, int nsamples)
+  : m_npoints(npoints)
+  , m_nsamples(nsamples > 0 ? std::min(nsamples, npoints) : npoints)
+  , m_inc_size(inc)
+  , m_input_stride(pad_to_cache_line<float>(npoints))
+  , m_output_stride(pad_to_cache_line<fftwf_complex>(npoints / 2 + 1))
+  , m_power(ngroups * get_num_frequencies(), 0)
+  , m_counts(ngroups, 0)
+{
+  // The window only covers the samples, not the padding
+  auto values = make_fourier_window(window, m_nsamples);
+  m_window.assign(values.begin(), values.end());
+  m_frequencies.reserve(npoints / 2 + 1);
+  for (int i = 0; i <= npoints / 2; ++i) {
+    m_frequencies.push_back(i / (m_inc_size * m_npoints));
+  }
+  // Create the plan of a full block now instead of with the first data
+  create_plans(m_npoints);
+}
+
+bool
+PlanePower::create_plans(int npoints)
+{
+  return FourierPlans::get().get_many_plan_float(npoints,
+                                                 s_channels_per_block,
+                                                 pad_to_cache_line<float>(npoints),
+                                                 pad_to_cache_line<fftwf_complex>(npoints / 2 + 1)) != nullptr;
+}
+
+bool
+PlanePower::add(const uint16_t* const* rows, const int* groups, size_t count)
+{
+  if (count == 0) {
+    return true;
+  }
+  fftwf_plan plan = FourierPlans::get().get_many_plan_float(m_npoints, count, m_input_stride, m_output_stride);
+  if (plan == nullptr) {
+    return false;
+  }
+
+  // Every thread reuses its own buffers, the padding after the samples is
+  // set every time since the buffers may have been used with other sizes
+  thread_local aligned_vector<float> input;
+  thread_local aligned_vector<std::complex<float>> transform;
+  input.resize(count * m_input_stride);
+  transform.resize(count * m_output_stride);
+  auto window_row_float = get_kernels().window_row_float;
+  for (size_t ich = 0; ich < count; ++ich) {
+    float* row = input.data() + ich * m_input_stride;
+    if (m_window.empty()) {
+      std::copy(rows[ich], rows[ich] + m_nsamples, row);
+    } else {
+      window_row_float(rows[ich], m_window.data(), m_nsamples, row);
+    }
+    std::fill(row + m_nsamples, row + m_npoints, 0);
+  }
+  fftwf_execute_dft_r2c(plan, input.data(), reinterpret_cast<fftwf_complex*>(transform.data())); // NOLINT
+
+  size_t nfreq = get_num_frequencies();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (size_t ich = 0; ich < count; ++ich) {
+    if (groups[ich] < 0) {
+      continue;
+    }
+    const std::complex<float>* in = transform.data() + ich * m_output_stride;
+    double* power = m_power.data() + groups[ich] * nfreq;
+    for (size_t k = 0; k < nfreq; ++k) {
+      power[k] += std::norm(in[k]);
+    }
+    ++m_counts[groups[ich]];
+  }
+  return true;
+}
+
+void
+PlanePower::clean()
+{
+  std::fill(m_power.begin(), m_power.end(), 0);
+  std::fill(m_counts.begin(), m_counts.end(), 0);
+}
+
+std::vector<float>
+PlanePower::get_power(size_t group) const
+{
+  size_t nfreq = get_num_frequencies();
+  if (m_counts[group] == 0) {
+    return std::vector<float>(nfreq, -1);
+  }
+  const double* power = m_power.data() + group * nfreq;
+  std::vector<float> ret(nfreq);
+  for (size_t k = 0; k < nfreq; ++k) {
+    ret[k] = power[k] / m_counts[group];
+  }
+  return ret;
+}
+
+std::vector<float>
+PlanePower::get_total_power() const
+{
+  size_t nfreq = get_num_frequencies();
+  uint64_t total = 0;
+  std::vector<double> sum(nfreq, 0);
+  for (size_t group = 0; group < m_counts.size(); ++group) {
+    total += m_counts[group];
+    for (size_t k = 0; k < nfreq; ++k) {
+      sum[k] += m_power[group * nfreq + k];
+    }
+  }
+  if (total == 0) {
+    return std::vector<float>(nfreq, -1);
+  }
+  std::vector<float> ret(nfreq);
+  for (size_t k = 0; k < nfreq; ++k) {
+    ret[k] = sum[k] / total;
+  }
+  return ret;
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_DQM_ALGS_PLANEPOWER_CPP_
@@ -9,6 +9,7 @@
 #define DQM_SRC_DQM_ALGS_RMS_CPP_
 
 #include "dqm/algs/RMS.hpp"
+#include "dqm/algs/Kernels.hpp"
 #include <cmath>
 
 /**
@@ -25,6 +26,15 @@ RMS::fill(const double x)
   m_sum_sq += x * x;
 }
 
+void
+RMS::fill(const uint16_t* adcs, size_t n)
+{
+  uint64_t sum = 0, sum_sq = 0;
+  get_kernels().sum_row(adcs, n, sum, sum_sq);
+  m_nentries += n;
+  m_sum_sq += sum_sq;
+}
+
 void
 RMS::clean()
 {
@@ -0,0 +1,151 @@
+/**
+ * @file RawReduction.cpp Reductions of the raw ADC values of a channel for displaying them
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_RAWREDUCTION_CPP_
+#define DQM_SRC_DQM_ALGS_RAWREDUCTION_CPP_
+
+#include "dqm/algs/RawReduction.hpp"
+#include "dqm/algs/Kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dunedaq::dqm {
+
+namespace {
+
+void
+reduce_stride(const uint16_t* adcs, size_t n, size_t bucket, std::vector<uint32_t>& out)
+{
+  for (size_t i = 0; i < n; i += bucket) {
+    out.push_back(adcs[i]);
+  }
+}
+
+void
+reduce_envelope(const uint16_t* adcs, size_t n, size_t bucket, std::vector<uint32_t>& out)
+{
+  // The kernel writes 16-bit values, they are widened when appended
+  thread_local std::vector<uint16_t> envelope;
+  envelope.resize(2 * ((n + bucket - 1) / bucket));
+  get_kernels().envelope_row(adcs, n, bucket, envelope.data());
+  out.insert(out.end(), envelope.begin(), envelope.end());
+}
+
+// The samples between the first and the last one are split in buckets and
+// from each one the point that makes the largest triangle with the point
+// chosen in the previous bucket and the average of the next bucket is kept
+void
+reduce_lttb(const uint16_t* adcs, size_t n, size_t bucket, std::vector<uint32_t>& out)
+{
+  if (n <= 2 || bucket <= 1) {
+    for (size_t i = 0; i < n; ++i) {
+      out.push_back(i);
+      out.push_back(adcs[i]);
+    }
+    return;
+  }
+  out.push_back(0);
+  out.push_back(adcs[0]);
+  size_t selected = 0;
+  for (size_t first = 1; first < n - 1; first += bucket) {
+    size_t last = std::min(first + bucket, n - 1);
+    // Average of the next bucket, the last sample for the last bucket
+    size_t next_last = std::min(last + bucket, n - 1);
+    double cx = n - 1, cy = adcs[n - 1];
+    if (last < n - 1) {
+      double sum = 0;
+      for (size_t i = last; i < next_last; ++i) {
+        sum += adcs[i];
+      }
+      cx = 0.5 * (last + next_last - 1);
+      cy = sum / (next_last - last);
+    }
+    double ax = selected, ay = adcs[selected];
+    // Twice the area, without branches so that the loop can be vectorized
+    size_t best = first;
+    double best_area = -1;
+    for (size_t i = first; i < last; ++i) {
+      double area = std::abs((ax - cx) * (adcs[i] - ay) - (ax - i) * (cy - ay));
+      bool larger = area > best_area;
+      best_area = larger ? area : best_area;
+      best = larger ? i : best;
+    }
+    out.push_back(best);
+    out.push_back(adcs[best]);
+    selected = best;
+  }
+  out.push_back(n - 1);
+  out.push_back(adcs[n - 1]);
+}
+
+} // namespace
+
+std::optional<RawReduction>
+parse_raw_reduction(const std::string& name)
+{
+  if (name == "none") {
+    return RawReduction::kNone;
+  }
+  if (name == "stride") {
+    return RawReduction::kStride;
+  }
+  if (name == "envelope") {
+    return RawReduction::kEnvelope;
+  }
+  if (name == "lttb") {
+    return RawReduction::kLTTB;
+  }
+  return std::nullopt;
+}
+
+const char*
+get_raw_reduction_name(RawReduction reduction)
+{
+  switch (reduction) {
+    case RawReduction::kStride:
+      return "stride";
+    case RawReduction::kEnvelope:
+      return "envelope";
+    case RawReduction::kLTTB:
+      return "lttb";
+    default:
+      return "none";
+  }
+}
+
+size_t
+get_raw_bucket(size_t nsamples, size_t points)
+{
+  if (points == 0) {
+    return 1;
+  }
+  return std::max<size_t>(1, (nsamples + points - 1) / points);
+}
+
+void
+reduce_raw(RawReduction reduction, const uint16_t* adcs, size_t n, size_t bucket, std::vector<uint32_t>& out)
+{
+  bucket = std::max<size_t>(bucket, 1);
+  switch (reduction) {
+    case RawReduction::kStride:
+      reduce_stride(adcs, n, bucket, out);
+      break;
+    case RawReduction::kEnvelope:
+      reduce_envelope(adcs, n, bucket, out);
+      break;
+    case RawReduction::kLTTB:
+      reduce_lttb(adcs, n, bucket, out);
+      break;
+    default:
+      out.insert(out.end(), adcs, adcs + n);
+  }
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_DQM_ALGS_RAWREDUCTION_CPP_
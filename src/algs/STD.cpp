@@ -9,6 +9,7 @@
 #define DQM_SRC_DQM_ALGS_STD_CPP_
 
 #include "dqm/algs/STD.hpp"
+#include "dqm/algs/Kernels.hpp"
 #include <cmath>
 
 /**
@@ -18,33 +19,80 @@
 namespace dunedaq {
 namespace dqm {
 
+namespace {
+// __extension__ keeps -pedantic quiet about the GCC 128-bit type
+__extension__ typedef unsigned __int128 uint128_t;
+}
+
 void
 STD::fill(double const x)
 {
   m_nentries++;
-  m_sum += x;
-  m_sum_sq += x * x;
+  double delta = x - m_mean;
+  m_mean += delta / m_nentries;
+  m_m2 += delta * (x - m_mean);
+}
+
+void
+STD::fill(const uint16_t* adcs, size_t n)
+{
+  if (n == 0) {
+    return;
+  }
+  // The ADC values are integers so the moments of the block are exact and
+  // then the block is merged like any other partial result
+  uint64_t sum = 0, sum_sq = 0;
+  get_kernels().sum_row(adcs, n, sum, sum_sq);
+  STD block;
+  block.m_nentries = n;
+  block.m_mean = static_cast<double>(sum) / n;
+  uint128_t sum_wide = sum;
+  block.m_m2 = static_cast<double>(static_cast<uint128_t>(n) * sum_sq - sum_wide * sum_wide) / n;
+  merge(block);
+}
+
+void
+STD::merge(const STD& other)
+{
+  if (other.m_nentries == 0) {
+    return;
+  }
+  if (m_nentries == 0) {
+    *this = other;
+    return;
+  }
+  double n_a = m_nentries, n_b = other.m_nentries;
+  double n = n_a + n_b;
+  double delta = other.m_mean - m_mean;
+  m_mean += delta * n_b / n;
+  m_m2 += other.m_m2 + delta * delta * n_a * n_b / n;
+  m_nentries += other.m_nentries;
 }
 
 void
 STD::clean()
 {
-  m_sum = 0;
-  m_sum_sq = 0;
   m_nentries = 0;
+  m_mean = 0;
+  m_m2 = 0;
 }
 
 double
-STD::std() const
+STD::mean() const
 {
-  if (m_std_set) {
-    return m_std;
+  if (m_nentries == 0) {
+    return -1;
   }
+  return m_mean;
+}
+
+double
+STD::std() const
+{
   if (m_nentries <= 1) {
     return -1;
   }
-  auto mean = m_sum / m_nentries;
-  return sqrt((m_sum_sq + m_nentries * mean * mean - 2 * m_sum * mean) / (m_nentries - 1));
+  return sqrt(m_m2 / (m_nentries - 1));
 }
 
 } // namespace dunedaq
@@ -0,0 +1,167 @@
+/**
+ * @file Unpack.cpp Kernels that unpack all the channels of a frame at once
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_UNPACK_CPP_
+#define DQM_SRC_DQM_ALGS_UNPACK_CPP_
+
+#include "dqm/algs/Unpack.hpp"
+#include "dqm/algs/Kernels.hpp"
+
+#include <cstring>
+
+#include <immintrin.h>
+
+namespace dunedaq::dqm {
+
+namespace {
+
+constexpr uint16_t adc_mask = (1 << WIB2_BITS_PER_ADC) - 1;
+
+/**
+ * @brief Unpack 4 channels (7 bytes) at a time starting from the given chunk
+ */
+inline void
+unpack_wib2_chunks(const uint8_t* bytes, uint16_t* out, int first_chunk)
+{
+  constexpr int bytes_per_chunk = 4 * WIB2_BITS_PER_ADC / 8;
+  for (int chunk = first_chunk; chunk < WIB2_CHANNELS / 4; ++chunk) {
+    uint64_t word = 0;
+    // Only 7 bytes are copied so that the last chunk doesn't read past the payload
+    std::memcpy(&word, bytes + chunk * bytes_per_chunk, bytes_per_chunk);
+    out[4 * chunk] = word & adc_mask;
+    out[4 * chunk + 1] = (word >> WIB2_BITS_PER_ADC) & adc_mask;
+    out[4 * chunk + 2] = (word >> (2 * WIB2_BITS_PER_ADC)) & adc_mask;
+    out[4 * chunk + 3] = (word >> (3 * WIB2_BITS_PER_ADC)) & adc_mask;
+  }
+}
+
+} // namespace
+
+void
+unpack_wib2_scalar(const uint32_t* adc_words, uint16_t* out)
+{
+  unpack_wib2_chunks(reinterpret_cast<const uint8_t*>(adc_words), out, 0); // NOLINT
+}
+
+// Groups of 8 channels take 14 bytes. Inside a group, channel c starts at byte
+// (14 * c) / 8 and has to be shifted right by (14 * c) % 8 bits, so that the
+// bytes are first shuffled into 32-bit lanes and then each lane is shifted
+// by its own amount
+
+/**
+ * @brief SSE4.2 version, 8 channels per iteration
+ */
+__attribute__((target("sse4.2"))) void
+unpack_wib2_sse42(const uint32_t* adc_words, uint16_t* out)
+{
+  auto bytes = reinterpret_cast<const uint8_t*>(adc_words); // NOLINT
+  const __m128i shuffle_lo = _mm_setr_epi8(0, 1, 2, -1, 1, 2, 3, -1, 3, 4, 5, -1, 5, 6, 7, -1);
+  const __m128i shuffle_hi = _mm_setr_epi8(7, 8, 9, -1, 8, 9, 10, -1, 10, 11, 12, -1, 12, 13, 14, -1);
+  // There are no variable shifts in SSE so every lane is shifted left
+  // to be aligned at bit 6 and then all are shifted right by 6
+  const __m128i align = _mm_setr_epi32(1 << 6, 1, 1 << 2, 1 << 4);
+  const __m128i mask = _mm_set1_epi32(adc_mask);
+
+  // The last group would read 2 bytes past the end of the payload
+  constexpr int simd_groups = WIB2_CHANNELS / 8 - 1;
+  for (int group = 0; group < simd_groups; ++group) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 14 * group)); // NOLINT
+    __m128i lo = _mm_shuffle_epi8(in, shuffle_lo);
+    __m128i hi = _mm_shuffle_epi8(in, shuffle_hi);
+    lo = _mm_and_si128(_mm_srli_epi32(_mm_mullo_epi32(lo, align), 6), mask);
+    hi = _mm_and_si128(_mm_srli_epi32(_mm_mullo_epi32(hi, align), 6), mask);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8 * group), _mm_packus_epi32(lo, hi)); // NOLINT
+  }
+  unpack_wib2_chunks(bytes, out, 2 * simd_groups);
+}
+
+/**
+ * @brief AVX2 version, 16 channels per iteration
+ */
+__attribute__((target("avx2"))) void
+unpack_wib2_avx2(const uint32_t* adc_words, uint16_t* out)
+{
+  auto bytes = reinterpret_cast<const uint8_t*>(adc_words); // NOLINT
+  // The lower lane gets the first 4 channels of the group and the upper lane the last 4
+  const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 1, 2, 3, -1, 3, 4, 5, -1, 5, 6, 7, -1,
+                                           7, 8, 9, -1, 8, 9, 10, -1, 10, 11, 12, -1, 12, 13, 14, -1);
+  const __m256i shifts = _mm256_setr_epi32(0, 6, 4, 2, 0, 6, 4, 2);
+  const __m256i mask = _mm256_set1_epi32(adc_mask);
+
+  // Pairs of groups while the 16-byte loads stay inside the payload
+  constexpr int simd_pairs = (WIB2_CHANNELS / 8 - 2) / 2;
+  for (int pair = 0; pair < simd_pairs; ++pair) {
+    const uint8_t* ptr = bytes + 28 * pair;
+    __m256i first = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr))); // NOLINT
+    __m256i second = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + 14))); // NOLINT
+    first = _mm256_and_si256(_mm256_srlv_epi32(_mm256_shuffle_epi8(first, shuffle), shifts), mask);
+    second = _mm256_and_si256(_mm256_srlv_epi32(_mm256_shuffle_epi8(second, shuffle), shifts), mask);
+    // packus works inside each lane, the permutation puts the channels back in order
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(first, second), 0xD8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 16 * pair), packed); // NOLINT
+  }
+  unpack_wib2_chunks(bytes, out, 4 * simd_pairs);
+}
+
+// GCC 12 reports the undefined first operands used inside avx512fintrin.h as
+// uninitialized once the intrinsics are inlined
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+namespace {
+
+/**
+ * @brief Load two consecutive groups, each one broadcast to two 128-bit lanes
+ */
+__attribute__((target("avx512f,avx512bw"))) inline __m512i
+load_wib2_group_pair(const uint8_t* bytes, int group)
+{
+  __m256i first = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 14 * group))); // NOLINT
+  __m256i second = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + 14 * group + 14))); // NOLINT
+  return _mm512_inserti64x4(_mm512_castsi256_si512(first), second, 1);
+}
+
+} // namespace
+
+/**
+ * @brief AVX-512 version, 32 channels per iteration
+ */
+__attribute__((target("avx512f,avx512bw"))) void
+unpack_wib2_avx512(const uint32_t* adc_words, uint16_t* out)
+{
+  auto bytes = reinterpret_cast<const uint8_t*>(adc_words); // NOLINT
+  const __m512i shuffle = _mm512_broadcast_i64x4(_mm256_setr_epi8(0, 1, 2, -1, 1, 2, 3, -1, 3, 4, 5, -1, 5, 6, 7, -1,
+                                                                  7, 8, 9, -1, 8, 9, 10, -1, 10, 11, 12, -1, 12, 13, 14, -1));
+  const __m512i shifts = _mm512_setr_epi32(0, 6, 4, 2, 0, 6, 4, 2, 0, 6, 4, 2, 0, 6, 4, 2);
+  const __m512i mask = _mm512_set1_epi32(adc_mask);
+  const __m512i order = _mm512_setr_epi64(0, 2, 4, 6, 1, 3, 5, 7);
+
+  // Blocks of 4 groups while the 16-byte loads stay inside the payload
+  constexpr int simd_blocks = (WIB2_CHANNELS / 8 - 2) / 4;
+  for (int block = 0; block < simd_blocks; ++block) {
+    __m512i first = load_wib2_group_pair(bytes, 4 * block);
+    __m512i second = load_wib2_group_pair(bytes, 4 * block + 2);
+    first = _mm512_and_si512(_mm512_srlv_epi32(_mm512_shuffle_epi8(first, shuffle), shifts), mask);
+    second = _mm512_and_si512(_mm512_srlv_epi32(_mm512_shuffle_epi8(second, shuffle), shifts), mask);
+    __m512i packed = _mm512_permutexvar_epi64(order, _mm512_packus_epi32(first, second));
+    _mm512_storeu_si512(out + 32 * block, packed);
+  }
+  unpack_wib2_chunks(bytes, out, 8 * simd_blocks);
+}
+
+#pragma GCC diagnostic pop
+
+void
+unpack_wib2(const uint32_t* adc_words, uint16_t* out)
+{
+  get_kernels().unpack_wib2(adc_words, out);
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_DQM_ALGS_UNPACK_CPP_
@@ -0,0 +1,173 @@
+/**
+ * @file WelchPSD.cpp Power spectral density of many channels averaged over segments and records
+ *
+ * This is part of the DUNE DAQ, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef DQM_SRC_DQM_ALGS_WELCHPSD_CPP_
+#define DQM_SRC_DQM_ALGS_WELCHPSD_CPP_
+
+#include "dqm/algs/WelchPSD.hpp"
+#include "dqm/algs/FourierPlans.hpp"
+#include "dqm/algs/FourierWindow.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// #include <complex> has to be before this include
+#include <fftw3.h>
+
+namespace dunedaq::dqm {
+
+WelchPSD::WelchPSD(size_t nchannels, int segment_length, int overlap, double inc)
+  : m_segment_length(segment_length)
+  , m_step(std::max(segment_length - overlap, 1))
+  , m_inc_size(inc)
+  , m_input_stride(pad_to_cache_line<float>(segment_length))
+  , m_output_stride(pad_to_cache_line<fftwf_complex>(segment_length / 2 + 1))
+  , m_window(segment_length)
+  , m_window_power(0)
+  , m_power(nchannels * m_output_stride, 0)
+  , m_counts(nchannels, 0)
+{
+  auto window = make_fourier_window(FourierWindowType::kHann, segment_length);
+  for (int i = 0; i < segment_length; ++i) {
+    m_window[i] = window[i];
+    m_window_power += static_cast<double>(m_window[i]) * m_window[i];
+  }
+  // Create the plan now instead of with the first data
+  create_plans(m_segment_length);
+}
+
+bool
+WelchPSD::create_plans(int segment_length)
+{
+  return FourierPlans::get().get_many_plan_float(segment_length,
+                                                 s_segments_per_plan,
+                                                 pad_to_cache_line<float>(segment_length),
+                                                 pad_to_cache_line<fftwf_complex>(segment_length / 2 + 1)) != nullptr;
+}
+
+void
+WelchPSD::fill(size_t ch, const uint16_t* adcs, size_t n)
+{
+  add_segments(ch, adcs, n);
+}
+
+void
+WelchPSD::fill(size_t ch, const double* values, size_t n)
+{
+  add_segments(ch, values, n);
+}
+
+template<class T>
+void
+WelchPSD::add_segments(size_t ch, const T* values, size_t n)
+{
+  if (n < static_cast<size_t>(m_segment_length)) {
+    return;
+  }
+  size_t nsegments = (n - m_segment_length) / m_step + 1;
+  size_t nfreq = get_num_frequencies();
+  float* power = m_power.data() + ch * m_output_stride;
+
+  // Every thread reuses its own buffers
+  thread_local aligned_vector<float> input;
+  thread_local aligned_vector<std::complex<float>> transform;
+  input.resize(s_segments_per_plan * m_input_stride);
+  transform.resize(s_segments_per_plan * m_output_stride);
+
+  for (size_t first = 0; first < nsegments; first += s_segments_per_plan) {
+    size_t count = std::min(s_segments_per_plan, nsegments - first);
+    fftwf_plan plan = FourierPlans::get().get_many_plan_float(m_segment_length, count, m_input_stride, m_output_stride);
+    if (plan == nullptr) {
+      return;
+    }
+    for (size_t iseg = 0; iseg < count; ++iseg) {
+      const T* segment = values + (first + iseg) * m_step;
+      double mean = 0;
+      for (int i = 0; i < m_segment_length; ++i) {
+        mean += segment[i];
+      }
+      mean /= m_segment_length;
+      float* row = input.data() + iseg * m_input_stride;
+      for (int i = 0; i < m_segment_length; ++i) {
+        row[i] = static_cast<float>(segment[i] - mean) * m_window[i];
+      }
+    }
+    fftwf_execute_dft_r2c(plan, input.data(), reinterpret_cast<fftwf_complex*>(transform.data())); // NOLINT
+    for (size_t iseg = 0; iseg < count; ++iseg) {
+      const std::complex<float>* row = transform.data() + iseg * m_output_stride;
+      for (size_t k = 0; k < nfreq; ++k) {
+        power[k] += std::norm(row[k]);
+      }
+    }
+  }
+  m_counts[ch] += nsegments;
+}
+
+void
+WelchPSD::merge(const WelchPSD& other)
+{
+  for (size_t i = 0; i < m_power.size(); ++i) {
+    m_power[i] += other.m_power[i];
+  }
+  for (size_t ch = 0; ch < m_counts.size(); ++ch) {
+    m_counts[ch] += other.m_counts[ch];
+  }
+}
+
+void
+WelchPSD::clean()
+{
+  std::fill(m_power.begin(), m_power.end(), 0);
+  std::fill(m_counts.begin(), m_counts.end(), 0);
+}
+
+std::vector<float>
+WelchPSD::get_psd(size_t ch) const
+{
+  size_t nfreq = get_num_frequencies();
+  if (m_counts[ch] == 0) {
+    return std::vector<float>(nfreq, -1);
+  }
+  // Periodogram normalization for a window, doubled for the one-sided
+  // spectrum except for the frequencies that don't have a negative pair
+  double scale = m_inc_size / (m_window_power * m_counts[ch]);
+  const float* power = m_power.data() + ch * m_output_stride;
+  std::vector<float> ret(nfreq);
+  for (size_t k = 0; k < nfreq; ++k) {
+    bool unpaired = k == 0 || (m_segment_length % 2 == 0 && k == nfreq - 1);
+    ret[k] = power[k] * scale * (unpaired ? 1 : 2);
+  }
+  return ret;
+}
+
+std::vector<double>
+WelchPSD::get_frequencies() const
+{
+  std::vector<double> ret;
+  for (int i = 0; i <= m_segment_length / 2; ++i) {
+    ret.push_back(i / (m_inc_size * m_segment_length));
+  }
+  return ret;
+}
+
+std::string
+WelchPSD::get_header_fields() const
+{
+  std::ostringstream fields;
+  fields << "\"segment_length\": \"" << m_segment_length << "\",";
+  fields << "\"nfreq\": \"" << get_num_frequencies() << "\",";
+  fields << "\"df\": \"" << std::setprecision(17) << 1 / (m_inc_size * m_segment_length) << "\"";
+  return fields.str();
+}
+
+} // namespace dunedaq::dqm
+
+#endif // DQM_SRC_DQM_ALGS_WELCHPSD_CPP_
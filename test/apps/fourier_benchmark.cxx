@@ -0,0 +1,85 @@
+/**
+ * @file fourier_benchmark.cxx Throughput of the per-channel Fourier transforms
+ *
+ * Compares a loop over one Fourier object per channel with FourierBatch, in
+ * double and single precision, on random ADC values. Usage:
+ *   fourier_benchmark [nchannels] [nsamples] [nthreads] [repetitions]
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "dqm/WorkerPool.hpp"
+#include "dqm/algs/Fourier.hpp"
+#include "dqm/algs/FourierBatch.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace dunedaq::dqm;
+
+int
+main(int argc, char* argv[])
+{
+  size_t nchannels = argc > 1 ? std::atoi(argv[1]) : 10240;
+  int nsamples = argc > 2 ? std::atoi(argv[2]) : 2048;
+  int nthreads = argc > 3 ? std::atoi(argv[3]) : 1;
+  int repetitions = argc > 4 ? std::atoi(argv[4]) : 3;
+
+  std::cout << nchannels << " channels x " << nsamples << " samples, " << nthreads << " threads, "
+            << repetitions << " repetitions" << std::endl;
+
+  std::mt19937 mt(1000007);
+  std::uniform_int_distribution<uint16_t> dist(0, (1 << 14) - 1);
+  std::vector<uint16_t> adcs(nchannels * nsamples);
+  for (auto& adc : adcs) {
+    adc = dist(mt);
+  }
+
+  WorkerPool workers(nthreads);
+
+  auto report = [&](const std::string& name, std::chrono::steady_clock::duration elapsed) {
+    double seconds = std::chrono::duration<double>(elapsed).count() / repetitions;
+    std::cout << name << ": " << seconds * 1e3 << " ms per record, " << nchannels / seconds << " channels/s" << std::endl;
+  };
+
+  // One Fourier object per channel, as FourierContainer used to do
+  {
+    std::vector<Fourier> fouriers(nchannels, Fourier(1, nsamples));
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repetitions; ++rep) {
+      workers.parallel_for(nchannels, [&](size_t ch) {
+        auto& fourier = fouriers[ch];
+        fourier.clean();
+        for (int i = 0; i < nsamples; ++i) {
+          fourier.fill(adcs[ch * nsamples + i]);
+        }
+        fourier.compute_fourier_transform();
+      });
+    }
+    report("Fourier per channel", std::chrono::steady_clock::now() - start);
+  }
+
+  auto run_batch = [&](const std::string& name, auto& batch) {
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repetitions; ++rep) {
+      workers.parallel_for(nchannels, [&](size_t ch) { batch.fill(ch, adcs.data() + ch * nsamples); });
+      workers.parallel_for(batch.get_num_blocks(), [&](size_t block) { batch.compute_block(block); });
+    }
+    report(name, std::chrono::steady_clock::now() - start);
+  };
+
+  {
+    FourierBatch<double> batch(nchannels, nsamples, 1);
+    run_batch("FourierBatch<double>", batch);
+  }
+  {
+    FourierBatch<float> batch(nchannels, nsamples, 1);
+    run_batch("FourierBatch<float>", batch);
+  }
+}
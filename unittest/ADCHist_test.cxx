@@ -0,0 +1,146 @@
+/**
+ * @file ADCHist_test.cxx Unit Tests for the histograms of ADC values
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE ADCHist_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "dqm/algs/ADCHist.hpp"
+#include "dqm/algs/ChannelStats.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace dunedaq::dqm;
+
+BOOST_AUTO_TEST_SUITE(ADCHist_test)
+
+std::mt19937 mt(1000007);
+
+BOOST_AUTO_TEST_CASE(ADCHist_fill)
+{
+  // Fills of different sizes so that every remainder of the sub-histograms is used
+  ADCHist<uint32_t> hist(3);
+  ChannelStats stats(3);
+  std::normal_distribution<double> dist(8000, 4);
+  std::vector<uint32_t> expected(hist.get_num_bins(), 0);
+  for (size_t n : { 1, 2, 3, 4, 5, 101, 1000 }) {
+    std::vector<uint16_t> adcs(n);
+    for (auto& adc : adcs) {
+      adc = std::lround(dist(mt));
+      expected[adc]++;
+    }
+    hist.fill(1, adcs.data(), n);
+    stats.fill(1, adcs.data(), n);
+  }
+  for (int b = 0; b < hist.get_num_bins(); ++b) {
+    BOOST_TEST_REQUIRE(hist.get_bins(1)[b] == expected[b]);
+  }
+  BOOST_TEST(hist.get_entries(1) == stats.get_count(1));
+  BOOST_TEST(hist.get_entries(0) == 0u);
+  BOOST_TEST(hist.mean(0) == -1);
+  BOOST_TEST(hist.mean(1) == stats.mean(1), boost::test_tools::tolerance(1e-12));
+  BOOST_TEST(hist.std(1) == stats.std(1), boost::test_tools::tolerance(1e-9));
+}
+
+BOOST_AUTO_TEST_CASE(ADCHist_range_and_saturation)
+{
+  // Bins for the values [100, 110)
+  ADCHist<uint16_t> hist(1, 10, 100);
+  std::vector<uint16_t> adcs { 0, 99, 100, 105, 109, 110, 16383 };
+  hist.fill(0, adcs.data(), adcs.size());
+  BOOST_TEST(hist.get_underflow(0) == 2u);
+  BOOST_TEST(hist.get_overflow(0) == 2u);
+  BOOST_TEST(hist.get_entries(0) == 3u);
+  BOOST_TEST(hist.get_bins(0)[5] == 1);
+  BOOST_TEST(hist.mean(0) == (100 + 105 + 109) / 3., boost::test_tools::tolerance(1e-12));
+
+  // The counts stop at the maximum of uint16_t
+  std::vector<uint16_t> many(70000, 101);
+  hist.fill(0, many.data(), many.size());
+  BOOST_TEST(hist.get_bins(0)[1] == 65535);
+  ADCHist<uint16_t> other(1, 10, 100);
+  other.fill(0, many.data(), 10);
+  hist.merge(other);
+  BOOST_TEST(hist.get_bins(0)[1] == 65535);
+  BOOST_TEST(hist.get_underflow(0) == 2u);
+
+  hist.clean();
+  BOOST_TEST(hist.get_entries(0) == 0u);
+  BOOST_TEST(hist.get_overflow(0) == 0u);
+  for (int b = 0; b < 10; ++b) {
+    BOOST_TEST_REQUIRE(hist.get_bins(0)[b] == 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ADCHist_merge_used_bins)
+{
+  // Channels with entries in different ranges, only those bins are touched
+  ADCHist<uint32_t> hist(2, 1 << 12);
+  ADCHist<uint32_t> other(2, 1 << 12);
+  std::vector<uint16_t> low { 10, 11, 12 };
+  std::vector<uint16_t> high { 3000, 3001 };
+  hist.fill(0, low.data(), low.size());
+  other.fill(0, high.data(), high.size());
+  other.fill(1, low.data(), low.size());
+  hist.merge(other);
+  BOOST_TEST(hist.get_entries(0) == 5u);
+  BOOST_TEST(hist.get_entries(1) == 3u);
+  BOOST_TEST(hist.get_bins(0)[3001] == 1u);
+  BOOST_TEST(hist.mean(0) == (10 + 11 + 12 + 3000 + 3001) / 5., boost::test_tools::tolerance(1e-12));
+
+  hist.clean();
+  for (int ch = 0; ch < 2; ++ch) {
+    for (int b = 0; b < 1 << 12; ++b) {
+      BOOST_TEST_REQUIRE(hist.get_bins(ch)[b] == 0u);
+    }
+  }
+  hist.fill(1, high.data(), high.size());
+  BOOST_TEST(hist.get_entries(1) == 2u);
+  BOOST_TEST(hist.get_entries(0) == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(ADCHist_quantiles)
+{
+  ADCHist<uint32_t> hist(2, 1 << 12);
+  BOOST_TEST(hist.quantile(0, 0.5) == -1);
+  BOOST_TEST(hist.truncated_std(0, 0, 4095) == -1);
+
+  // 10 entries at 100 and 10 at 101: half of them below 100.5
+  std::vector<uint16_t> adcs(10, 100);
+  adcs.resize(20, 101);
+  hist.fill(0, adcs.data(), adcs.size());
+  BOOST_TEST(hist.quantile(0, 0.5) == 100.5, boost::test_tools::tolerance(1e-12));
+  BOOST_TEST(hist.quantile(0, 0.25) == 100, boost::test_tools::tolerance(1e-12));
+  BOOST_TEST(hist.quantile(0, 0.75) == 101, boost::test_tools::tolerance(1e-12));
+
+  // Gaussian noise with large pulses in 5% of the samples: the quantiles
+  // and the truncated standard deviation stay close to the noise
+  double sigma = 6;
+  std::normal_distribution<double> noise(900, sigma);
+  std::bernoulli_distribution pulse(0.05);
+  std::vector<uint16_t> values(200000);
+  for (auto& value : values) {
+    value = std::lround(noise(mt)) + (pulse(mt) ? 1500 : 0);
+  }
+  hist.fill(1, values.data(), values.size());
+  BOOST_TEST(std::abs(hist.quantile(1, 0.5) - 900) < 0.5);
+  double iqr_sigma = (hist.quantile(1, 0.75) - hist.quantile(1, 0.25)) / 1.349;
+  BOOST_TEST(std::abs(iqr_sigma / sigma - 1) < 0.1);
+  BOOST_TEST(hist.std(1) > 50 * sigma);
+  // A gaussian truncated at 3 sigma has a standard deviation of 0.986 sigma
+  double truncated = hist.truncated_std(1, 900 - 3 * sigma, 900 + 3 * sigma);
+  BOOST_TEST(std::abs(truncated / (0.986 * sigma) - 1) < 0.05);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,147 @@
+/**
+ * @file ChannelGroups_test.cxx Unit Tests for the sums of groups of channels
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE ChannelGroups_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "dqm/ADCMatrix.hpp"
+#include "dqm/ChannelGroups.hpp"
+#include "dqm/ChannelMap.hpp"
+#include "dqm/Constants.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace dunedaq::dqm;
+
+BOOST_AUTO_TEST_SUITE(ChannelGroups_test)
+
+std::mt19937 mt(1000007);
+
+/**
+ * @brief Matrix with random values for the given links
+ */
+ADCMatrix
+make_matrix(const std::vector<int>& links, size_t nsamples)
+{
+  std::uniform_int_distribution<uint16_t> dist(0, (1 << 14) - 1);
+  ADCMatrix matrix;
+  matrix.allocate(links, std::vector<size_t>(links.size(), nsamples));
+  for (size_t slot = 0; slot < links.size(); ++slot) {
+    for (int ich = 0; ich < CHANNELS_PER_LINK; ++ich) {
+      for (size_t i = 0; i < nsamples; ++i) {
+        matrix.row(slot, ich)[i] = dist(mt);
+      }
+    }
+  }
+  return matrix;
+}
+
+BOOST_AUTO_TEST_CASE(ChannelGroups_planes)
+{
+  std::vector<int> links{ 3, 7 };
+  size_t nsamples = 37;
+  auto matrix = make_matrix(links, nsamples);
+
+  // Plane of each channel as in the channel map, 3 is not summed
+  ChannelMap map;
+  for (int link : links) {
+    for (int ich = 0; ich < CHANNELS_PER_LINK; ++ich) {
+      map.m_map_rev[link][ich] = { (ich + link) % 4, 1000 * link + ich };
+    }
+  }
+
+  ChannelGroups groups(ChannelGrouping::kPlane, LinkIndex(links));
+  BOOST_TEST_REQUIRE(groups.get_num_groups() == 3);
+  groups.set_planes(map);
+  BOOST_TEST(groups.get_group(1, 1) == 0);
+  BOOST_TEST(groups.get_group(0, 0) == -1);
+
+  for (size_t plane = 0; plane < 3; ++plane) {
+    std::vector<double> sum(nsamples, 0.5), expected(nsamples, 0.5);
+    groups.add(matrix, nsamples, plane, sum.data());
+    for (size_t slot = 0; slot < links.size(); ++slot) {
+      for (int ich = 0; ich < CHANNELS_PER_LINK; ++ich) {
+        if (static_cast<size_t>((ich + links[slot]) % 4) != plane) {
+          continue;
+        }
+        for (size_t i = 0; i < nsamples; ++i) {
+          expected[i] += matrix.row(slot, ich)[i];
+        }
+      }
+    }
+    BOOST_TEST_REQUIRE(sum == expected, boost::test_tools::per_element());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ChannelGroups_femb_and_asic)
+{
+  std::vector<int> links{ 2, 5, 9 };
+  size_t nsamples = 20;
+  auto matrix = make_matrix(links, nsamples);
+
+  ChannelGroups fembs(ChannelGrouping::kFEMB, LinkIndex(links));
+  ChannelGroups asics(ChannelGrouping::kASIC, LinkIndex(links));
+  BOOST_TEST_REQUIRE(fembs.get_num_groups() == 6);
+  BOOST_TEST_REQUIRE(asics.get_num_groups() == 48);
+  BOOST_TEST((fembs.get_location(3) == std::pair<int, int>(5, 1)));
+  BOOST_TEST((asics.get_location(17) == std::pair<int, int>(5, 1)));
+
+  // Adding all the ASICs of a FEMB gives the FEMB
+  std::vector<double> femb(nsamples, 0), asic(nsamples, 0);
+  fembs.add(matrix, nsamples, 3, femb.data());
+  for (size_t group = 24; group < 32; ++group) {
+    asics.add(matrix, nsamples, group, asic.data());
+  }
+  BOOST_TEST_REQUIRE(femb == asic, boost::test_tools::per_element());
+
+  std::vector<double> expected(nsamples, 0);
+  for (int ich = 16; ich < 32; ++ich) {
+    for (size_t i = 0; i < nsamples; ++i) {
+      expected[i] += matrix.row(1, ich)[i];
+    }
+  }
+  std::fill(asic.begin(), asic.end(), 0);
+  asics.add(matrix, nsamples, 17, asic.data());
+  BOOST_TEST_REQUIRE(asic == expected, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(ChannelGroups_missing_link)
+{
+  // Links of the index that are not in the record are skipped
+  size_t nsamples = 8;
+  auto matrix = make_matrix({ 1 }, nsamples);
+  ChannelGroups fembs(ChannelGrouping::kFEMB, LinkIndex({ 0, 1 }));
+  std::vector<double> sum(nsamples, 0), expected(nsamples, 0);
+  fembs.add(matrix, nsamples, 0, sum.data());
+  BOOST_TEST_REQUIRE(sum == expected, boost::test_tools::per_element());
+  fembs.add(matrix, nsamples, 2, sum.data());
+  for (int ich = 0; ich < 128; ++ich) {
+    for (size_t i = 0; i < nsamples; ++i) {
+      expected[i] += matrix.row(0, ich)[i];
+    }
+  }
+  BOOST_TEST_REQUIRE(sum == expected, boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(ChannelGroups_parse_grouping)
+{
+  BOOST_TEST_REQUIRE((parse_channel_grouping("plane") == ChannelGrouping::kPlane));
+  BOOST_TEST_REQUIRE((parse_channel_grouping("femb") == ChannelGrouping::kFEMB));
+  BOOST_TEST_REQUIRE((parse_channel_grouping("asic") == ChannelGrouping::kASIC));
+  BOOST_TEST_REQUIRE(!parse_channel_grouping("fembs").has_value());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,167 @@
+/**
+ * @file ChannelStats_test.cxx Unit Tests for the statistics stored as separate arrays
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE ChannelStats_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "dqm/algs/ChannelStats.hpp"
+#include "dqm/algs/ChannelSummary.hpp"
+#include "dqm/algs/RMS.hpp"
+#include "dqm/algs/STD.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace dunedaq::dqm;
+
+BOOST_AUTO_TEST_SUITE(ChannelStats_test)
+
+std::mt19937 mt(1000007);
+
+BOOST_AUTO_TEST_CASE(ChannelStats_against_STD_RMS)
+{
+  constexpr size_t nchannels = 64;
+  ChannelStats stats(nchannels);
+  std::vector<STD> stds(nchannels);
+  std::vector<RMS> rmss(nchannels);
+
+  // Fill every channel in a few calls as when several links or records are added
+  for (int call = 0; call < 3; ++call) {
+    for (size_t ch = 0; ch < nchannels; ++ch) {
+      std::uniform_int_distribution<uint16_t> dist(ch * 100, ch * 100 + 50);
+      std::vector<uint16_t> adcs(1000 + ch);
+      for (auto& adc : adcs) {
+        adc = dist(mt);
+      }
+      stats.fill(ch, adcs.data(), adcs.size());
+      for (auto adc : adcs) {
+        stds[ch].fill(adc);
+        rmss[ch].fill(adc);
+      }
+    }
+  }
+
+  for (size_t ch = 0; ch < nchannels; ++ch) {
+    BOOST_TEST_REQUIRE(stats.get_count(ch) == 3 * (1000 + ch));
+    BOOST_TEST_REQUIRE(std::abs(stats.std(ch) - stds[ch].std()) < 1e-6);
+    BOOST_TEST_REQUIRE(std::abs(stats.rms(ch) - rmss[ch].rms()) < 1e-6);
+  }
+
+  stats.clean();
+  BOOST_TEST(stats.get_count(0) == 0);
+  BOOST_TEST(stats.std(0) == -1);
+  BOOST_TEST(stats.rms(0) == -1);
+  BOOST_TEST(stats.mean(0) == -1);
+}
+
+BOOST_AUTO_TEST_CASE(ChannelStats_large_pedestal)
+{
+  // A small spread on top of a large value is where the sum of squares loses precision
+  ChannelStats stats(1);
+  std::vector<uint16_t> adcs(1000000);
+  for (size_t i = 0; i < adcs.size(); ++i) {
+    adcs[i] = 16000 + (i % 2);
+  }
+  stats.fill(0, adcs.data(), adcs.size());
+  double expected = std::sqrt(0.25 * adcs.size() / (adcs.size() - 1));
+  BOOST_TEST(std::abs(stats.std(0) - expected) < 1e-9);
+  BOOST_TEST(std::abs(stats.mean(0) - 16000.5) < 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(ChannelStats_merge)
+{
+  // One partial result per link, as when every thread fills its own copy
+  constexpr size_t nchannels = 8;
+  ChannelStats all(nchannels);
+  std::vector<ChannelStats> parts(3, ChannelStats(nchannels));
+  std::uniform_int_distribution<uint16_t> dist(15000, 16383);
+  for (size_t ipart = 0; ipart < parts.size(); ++ipart) {
+    for (size_t ch = 0; ch < nchannels; ++ch) {
+      std::vector<uint16_t> adcs(500 + 11 * ipart);
+      for (auto& adc : adcs) {
+        adc = dist(mt);
+      }
+      parts[ipart].fill(ch, adcs.data(), adcs.size());
+      all.fill(ch, adcs.data(), adcs.size());
+    }
+  }
+  ChannelStats merged(nchannels);
+  for (auto& part : parts) {
+    merged.merge(part);
+  }
+  for (size_t ch = 0; ch < nchannels; ++ch) {
+    BOOST_TEST_REQUIRE(merged.get_count(ch) == all.get_count(ch));
+    BOOST_TEST_REQUIRE(merged.std(ch) == all.std(ch));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ChannelSummary_single_pass)
+{
+  constexpr size_t nchannels = 16;
+  ChannelSummary summary(nchannels);
+  summary.set_full_scale(4095);
+  ChannelStats stats(nchannels);
+  std::vector<int> mins(nchannels, 1 << 16), maxs(nchannels, -1);
+  std::vector<uint64_t> zeros(nchannels), saturated(nchannels);
+
+  std::uniform_int_distribution<uint16_t> dist(0, 4095);
+  for (int call = 0; call < 2; ++call) {
+    for (size_t ch = 0; ch < nchannels; ++ch) {
+      std::vector<uint16_t> adcs(5000 + 7 * ch);
+      for (auto& adc : adcs) {
+        adc = dist(mt);
+      }
+      // Make sure there are values at the edges
+      adcs[ch] = 0;
+      adcs[ch + 1] = 4095;
+      summary.fill(ch, adcs.data(), adcs.size());
+      stats.fill(ch, adcs.data(), adcs.size());
+      for (auto adc : adcs) {
+        mins[ch] = std::min<int>(mins[ch], adc);
+        maxs[ch] = std::max<int>(maxs[ch], adc);
+        zeros[ch] += adc == 0;
+        saturated[ch] += adc == 4095;
+      }
+    }
+  }
+
+  for (size_t ch = 0; ch < nchannels; ++ch) {
+    BOOST_TEST_REQUIRE(summary.get_count(ch) == stats.get_count(ch));
+    BOOST_TEST_REQUIRE(summary.get_sum(ch) == stats.get_sum(ch));
+    BOOST_TEST_REQUIRE(summary.get_sum_sq(ch) == stats.get_sum_sq(ch));
+    BOOST_TEST_REQUIRE(summary.min(ch) == mins[ch]);
+    BOOST_TEST_REQUIRE(summary.max(ch) == maxs[ch]);
+    BOOST_TEST_REQUIRE(summary.get_zeros(ch) == zeros[ch]);
+    BOOST_TEST_REQUIRE(summary.get_saturated(ch) == saturated[ch]);
+  }
+
+  // Merging into an empty summary gives the same result
+  ChannelSummary merged(nchannels);
+  merged.merge(summary);
+  for (size_t ch = 0; ch < nchannels; ++ch) {
+    BOOST_TEST_REQUIRE(merged.get_count(ch) == summary.get_count(ch));
+    BOOST_TEST_REQUIRE(merged.min(ch) == summary.min(ch));
+    BOOST_TEST_REQUIRE(merged.max(ch) == summary.max(ch));
+    BOOST_TEST_REQUIRE(merged.get_saturated(ch) == summary.get_saturated(ch));
+  }
+
+  summary.clean();
+  BOOST_TEST(summary.get_count(0) == 0);
+  BOOST_TEST(summary.min(0) == -1);
+  BOOST_TEST(summary.max(0) == -1);
+  BOOST_TEST(summary.get_saturated(0) == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,156 @@
+/**
+ * @file Counter_test.cxx Unit Tests for the buffer of raw ADC values
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE Counter_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "dqm/algs/Counter.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+using namespace dunedaq::dqm;
+
+BOOST_AUTO_TEST_SUITE(Counter_test)
+
+BOOST_AUTO_TEST_CASE(Counter_fill_and_gather)
+{
+  Counter counter(3, 10);
+  BOOST_TEST(counter.size() == 3u);
+  BOOST_TEST(counter.get_capacity() >= 10u);
+
+  std::vector<uint16_t> adcs(10);
+  std::iota(adcs.begin(), adcs.end(), 100);
+  counter.fill(0, adcs.data(), 10);
+  counter.fill(2, adcs.data(), 4);
+
+  std::vector<uint32_t> out;
+  counter.gather(2, out);
+  counter.gather(1, out);
+  counter.gather(0, out);
+  BOOST_TEST(out.size() == 14u);
+  BOOST_TEST(out[3] == 103);
+  BOOST_TEST(out[4] == 100);
+
+  // Values that don't fit are dropped until there is space for them
+  size_t capacity = counter.get_capacity();
+  std::vector<uint16_t> many(capacity, 7);
+  counter.fill(0, many.data(), many.size());
+  BOOST_TEST(counter.get_num_samples(0) == capacity);
+
+  counter.reserve_samples(capacity);
+  BOOST_TEST(counter.get_capacity() >= 2 * capacity);
+  counter.fill(0, many.data(), many.size());
+  BOOST_TEST(counter.get_num_samples(0) == 2 * capacity);
+  // The samples are kept when the buffer grows
+  BOOST_TEST(counter.get_samples(0)[9] == 109);
+  BOOST_TEST(counter.get_samples(2)[3] == 103);
+
+  counter.clean();
+  BOOST_TEST(counter.get_num_samples(0) == 0u);
+  out.clear();
+  counter.gather(0, out);
+  BOOST_TEST(out.empty());
+}
+
+BOOST_AUTO_TEST_CASE(Counter_reduction)
+{
+  size_t n = 960;
+  Counter counter(1, n);
+  std::vector<uint16_t> adcs(n, 500);
+  adcs[123] = 900;
+  adcs[456] = 100;
+  counter.fill(0, adcs.data(), n);
+  BOOST_TEST(counter.get_header_fields().empty());
+
+  counter.set_reduction(RawReduction::kStride, 96);
+  BOOST_TEST(counter.get_bucket() == 10u);
+  BOOST_TEST(counter.get_header_fields() == "\"reduction\": \"stride\",\"bucket\": \"10\"");
+  std::vector<uint32_t> out;
+  counter.gather(0, out);
+  BOOST_TEST(out.size() == 96u);
+
+  // The envelope keeps the spikes that the stride misses
+  counter.set_reduction(RawReduction::kEnvelope, 96);
+  out.clear();
+  counter.gather(0, out);
+  BOOST_TEST(out.size() == 2 * 96u);
+  BOOST_TEST(out[2 * 12 + 1] == 900u);
+  BOOST_TEST(out[2 * 45] == 100u);
+  BOOST_TEST(*std::min_element(out.begin(), out.end()) == 100u);
+
+  // LTTB sends (index, value) pairs, the first and last samples and one per bucket
+  counter.set_reduction(RawReduction::kLTTB, 96);
+  out.clear();
+  counter.gather(0, out);
+  BOOST_TEST(out.size() == 2 * (2 + (n - 2 + 9) / 10));
+  BOOST_TEST(out[0] == 0u);
+  BOOST_TEST(out[out.size() - 2] == n - 1);
+  bool has_spike = false;
+  for (size_t i = 0; i < out.size(); i += 2) {
+    BOOST_TEST(out[i + 1] == adcs[out[i]]);
+    has_spike = has_spike || out[i] == 123u;
+  }
+  BOOST_TEST(has_spike);
+
+  // No points means no reduction
+  counter.set_reduction(RawReduction::kEnvelope, 0);
+  out.clear();
+  counter.gather(0, out);
+  BOOST_TEST(out.size() == n);
+}
+
+BOOST_AUTO_TEST_CASE(Counter_reduction_padded_rows)
+{
+  // The rows are padded to 6016 samples, the buckets come from the 6000
+  // samples that arrived and not from the padding
+  size_t n = 6000;
+  Counter counter(2, n);
+  BOOST_TEST(counter.get_capacity() > n);
+  std::vector<uint16_t> adcs(n, 500);
+  counter.fill(0, adcs.data(), n);
+  counter.fill(1, adcs.data(), n / 2);
+
+  counter.set_reduction(RawReduction::kStride, 1000);
+  BOOST_TEST(counter.get_bucket() == 6u);
+  BOOST_TEST(counter.get_header_fields() == "\"reduction\": \"stride\",\"bucket\": \"6\"");
+  std::vector<uint32_t> out;
+  counter.gather(0, out);
+  BOOST_TEST(out.size() == 1000u);
+  // The bucket is the same for the channels with fewer samples
+  out.clear();
+  counter.gather(1, out);
+  BOOST_TEST(out.size() == 500u);
+
+  // Growing the rows doesn't change the bucket either
+  counter.reserve_samples(n);
+  BOOST_TEST(counter.get_bucket() == 6u);
+
+  counter.set_reduction(RawReduction::kEnvelope, 1000);
+  out.clear();
+  counter.gather(0, out);
+  BOOST_TEST(out.size() == 2 * 1000u);
+}
+
+BOOST_AUTO_TEST_CASE(Counter_parse_reduction)
+{
+  BOOST_TEST((parse_raw_reduction("envelope") == RawReduction::kEnvelope));
+  BOOST_TEST((parse_raw_reduction("lttb") == RawReduction::kLTTB));
+  BOOST_TEST((parse_raw_reduction("stride") == RawReduction::kStride));
+  BOOST_TEST((parse_raw_reduction("none") == RawReduction::kNone));
+  BOOST_TEST(!parse_raw_reduction("something").has_value());
+  BOOST_TEST(get_raw_reduction_name(RawReduction::kLTTB) == std::string("lttb"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -14,9 +14,17 @@
 #include "boost/test/unit_test.hpp"
 
 #include "dqm/algs/Fourier.hpp"
+#include "dqm/algs/FourierBands.hpp"
+#include "dqm/algs/FourierBatch.hpp"
+#include "dqm/algs/FourierPlans.hpp"
+#include "dqm/algs/FourierWindow.hpp"
 
+#include <cmath>
 #include <complex>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
+#include <random>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -121,4 +129,326 @@ BOOST_AUTO_TEST_CASE(Fourier_test6)
   Fourier_test_case(T, N, ys, outx, outy);
 }
 
+BOOST_AUTO_TEST_CASE(Fourier_shared_plan)
+{
+  // Several objects of the same size use the same plan and each one keeps its own result
+  int N = 128;
+  auto plan = FourierPlans::get().get_plan(N);
+  BOOST_TEST_REQUIRE(plan != nullptr);
+  BOOST_TEST(FourierPlans::get().get_plan(N) == plan);
+
+  std::vector<Fourier> fouriers(3, Fourier(1, N));
+  for (size_t f = 0; f < fouriers.size(); ++f) {
+    for (int i = 0; i < N; ++i) {
+      fouriers[f].fill(std::cos(2 * M_PI * (f + 1) * i / N));
+    }
+  }
+  // Twice, to check that the buffers can be reused after clean
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    for (size_t f = 0; f < fouriers.size(); ++f) {
+      if (repeat) {
+        auto data = fouriers[f].m_data;
+        fouriers[f].clean();
+        for (auto x : data) {
+          fouriers[f].fill(x);
+        }
+      }
+      fouriers[f].compute_fourier_transform();
+      auto res = fouriers[f].get_transform();
+      BOOST_TEST_REQUIRE(res.size() == static_cast<size_t>(N / 2 + 1));
+      for (int k = 0; k <= N / 2; ++k) {
+        double expected = k == static_cast<int>(f + 1) ? N / 2. : 0;
+        BOOST_TEST_REQUIRE(std::abs(std::abs(res[k]) - expected) < 1e-6);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Fourier_buffers_after_clean)
+{
+  // The transform keeps its size after clean and when there are not enough
+  // samples, has_transform tells if it can be used
+  int N = 64;
+  Fourier a(1, N), b(1, N), sum(1, N);
+  for (int i = 0; i < N; ++i) {
+    a.fill(std::cos(2 * M_PI * 3 * i / N));
+    b.fill(std::cos(2 * M_PI * 5 * i / N));
+  }
+  BOOST_TEST_REQUIRE(a.compute_fourier_transform());
+  BOOST_TEST_REQUIRE(b.compute_fourier_transform());
+  const double* frequencies = a.get_frequencies().data();
+
+  sum.set_sum({&a, &b});
+  BOOST_TEST(sum.has_transform());
+  std::vector<float> magnitudes(sum.get_frequencies().size());
+  sum.get_magnitudes(magnitudes.data());
+  for (int k = 0; k <= N / 2; ++k) {
+    double expected = (k == 3 || k == 5) ? N / 2. : 0;
+    BOOST_TEST_REQUIRE(std::abs(magnitudes[k] - expected) < 1e-4);
+  }
+
+  a.clean();
+  BOOST_TEST(!a.has_transform());
+  BOOST_TEST(a.get_transform().size() == static_cast<size_t>(N / 2 + 1));
+  for (int i = 0; i < N / 2; ++i) {
+    a.fill(1);
+  }
+  BOOST_TEST(!a.compute_fourier_transform());
+  BOOST_TEST(!a.has_transform());
+  BOOST_TEST(a.get_transform().size() == static_cast<size_t>(N / 2 + 1));
+  // The frequencies are not rebuilt
+  BOOST_TEST(a.get_frequencies().data() == frequencies);
+}
+
+BOOST_AUTO_TEST_CASE(Fourier_lengths)
+{
+  BOOST_TEST(is_fast_fourier_length(1));
+  BOOST_TEST(is_fast_fourier_length(2 * 2 * 3 * 5 * 5));
+  BOOST_TEST(!is_fast_fourier_length(7 * 4));
+  BOOST_TEST(!is_fast_fourier_length(0));
+  // 1009 is prime
+  BOOST_TEST(get_fourier_length(1009, FourierLength::kExact) == 1009);
+  BOOST_TEST(get_fourier_length(1009, FourierLength::kRoundDown) == 1000);
+  BOOST_TEST(get_fourier_length(1009, FourierLength::kPadUp) == 1024);
+  BOOST_TEST(get_fourier_length(1024, FourierLength::kPadUp) == 1024);
+  BOOST_TEST((parse_fourier_length("up") == FourierLength::kPadUp));
+  BOOST_TEST((parse_fourier_length("exact") == FourierLength::kExact));
+  BOOST_TEST(!parse_fourier_length("upp").has_value());
+  BOOST_TEST((parse_fourier_window("blackman") == FourierWindowType::kBlackman));
+  BOOST_TEST((parse_fourier_window("none") == FourierWindowType::kNone));
+  BOOST_TEST(!parse_fourier_window("other").has_value());
+  BOOST_TEST(make_fourier_window(FourierWindowType::kNone, 10).empty());
+}
+
+BOOST_AUTO_TEST_CASE(Fourier_window_and_padding)
+{
+  // A tone between two bins leaks to all the frequencies without a window,
+  // with a Hann window the far frequencies are orders of magnitude lower
+  int N = 500;
+  int padded = get_fourier_length(N - 1, FourierLength::kPadUp);
+  BOOST_TEST_REQUIRE(padded == N);
+  Fourier plain(1, N), hann(1, N, FourierWindowType::kHann), pad(1, padded, FourierWindowType::kHann, N - 1);
+  BOOST_TEST(pad.get_num_samples() == N - 1);
+  std::vector<double> samples(N);
+  for (int i = 0; i < N; ++i) {
+    samples[i] = std::cos(2 * M_PI * 40.5 * i / N);
+    plain.fill(samples[i]);
+    hann.fill(samples[i]);
+    pad.fill(samples[i]);
+  }
+  BOOST_TEST_REQUIRE(plain.compute_fourier_transform());
+  BOOST_TEST_REQUIRE(hann.compute_fourier_transform());
+  BOOST_TEST_REQUIRE(pad.compute_fourier_transform());
+  BOOST_TEST(std::abs(hann.get_transform()[150]) < 1e-3 * std::abs(plain.get_transform()[150]));
+
+  // The padded one is the transform of the windowed samples followed by zeros
+  auto window = make_fourier_window(FourierWindowType::kHann, N - 1);
+  for (int k : { 0, 40, 41, 150 }) {
+    std::complex<double> expected = 0;
+    for (int i = 0; i < N - 1; ++i) {
+      expected += samples[i] * window[i] * std::polar(1., -2 * M_PI * k * i / padded);
+    }
+    BOOST_TEST_REQUIRE(std::abs(pad.get_transform()[k] - expected) < 1e-6);
+  }
+}
+
+template<class R>
+void
+FourierBatch_test_case(double tolerance)
+{
+  // Not a multiple of the block size so that the last block has its own plan
+  size_t nchannels = FourierBatch<R>::s_channels_per_block + 13;
+  int N = 250;
+  double T = 0.5;
+  std::mt19937 mt(1000007);
+  std::uniform_int_distribution<uint16_t> dist(0, (1 << 14) - 1);
+
+  FourierBatch<R> batch(nchannels, N, T);
+  std::vector<std::vector<uint16_t>> adcs(nchannels, std::vector<uint16_t>(N));
+  for (size_t ch = 0; ch < nchannels; ++ch) {
+    for (auto& adc : adcs[ch]) {
+      adc = dist(mt);
+    }
+    batch.fill(ch, adcs[ch].data());
+  }
+  batch.clear(1);
+  BOOST_TEST_REQUIRE(batch.compute());
+
+  Fourier reference(T, N);
+  BOOST_TEST_REQUIRE((batch.get_frequencies() == reference.get_frequencies()));
+  for (size_t ch = 0; ch < nchannels; ++ch) {
+    reference.clean();
+    for (auto adc : adcs[ch]) {
+      reference.fill(ch == 1 ? 0 : adc);
+    }
+    reference.compute_fourier_transform();
+    auto expected = reference.get_transform();
+    const R* magnitudes = batch.get_magnitudes(ch);
+    // The error of the transform grows with the DC term, which is the largest
+    double scale = std::abs(expected[0]) + 1;
+    for (size_t k = 0; k < batch.get_num_frequencies(); ++k) {
+      BOOST_TEST_REQUIRE(std::abs(magnitudes[k] - std::abs(expected[k])) < tolerance * scale);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(FourierBatch_against_Fourier)
+{
+  FourierBatch_test_case<double>(1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(FourierBatch_single_precision)
+{
+  FourierBatch_test_case<float>(1e-5);
+}
+
+BOOST_AUTO_TEST_CASE(FourierBatch_window_and_padding)
+{
+  // Same result as Fourier with the same window and padding
+  int N = 96, nsamples = 90;
+  double T = 0.5;
+  std::uniform_int_distribution<uint16_t> dist(0, (1 << 12) - 1);
+  FourierBatch<double> batch(3, N, T, FourierWindowType::kBlackman, nsamples);
+  FourierBatch<float> batch_float(3, N, T, FourierWindowType::kBlackman, nsamples);
+  std::vector<std::vector<uint16_t>> adcs(3, std::vector<uint16_t>(N));
+  std::mt19937 mt(1000007);
+  for (size_t ch = 0; ch < adcs.size(); ++ch) {
+    for (auto& adc : adcs[ch]) {
+      adc = dist(mt);
+    }
+    batch.fill(ch, adcs[ch].data());
+    batch_float.fill(ch, adcs[ch].data());
+  }
+  BOOST_TEST_REQUIRE(batch.compute());
+  BOOST_TEST_REQUIRE(batch_float.compute());
+
+  Fourier reference(T, N, FourierWindowType::kBlackman, nsamples);
+  for (size_t ch = 0; ch < adcs.size(); ++ch) {
+    reference.clean();
+    for (auto adc : adcs[ch]) {
+      reference.fill(adc);
+    }
+    BOOST_TEST_REQUIRE(reference.compute_fourier_transform());
+    auto expected = reference.get_transform();
+    double scale = std::abs(expected[0]) + 1;
+    for (size_t k = 0; k < batch.get_num_frequencies(); ++k) {
+      BOOST_TEST_REQUIRE(std::abs(batch.get_magnitudes(ch)[k] - std::abs(expected[k])) < 1e-9 * scale);
+      BOOST_TEST_REQUIRE(std::abs(batch_float.get_magnitudes(ch)[k] - std::abs(expected[k])) < 1e-5 * scale);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Fourier_wisdom)
+{
+  std::string filename = "Fourier_test_wisdom.txt";
+  auto& plans = FourierPlans::get();
+  auto rigor = plans.get_rigor();
+  plans.set_rigor(parse_fourier_rigor("measure").value());
+  BOOST_TEST(plans.get_rigor() == FFTW_MEASURE);
+  BOOST_TEST_REQUIRE(plans.get_plan(96) != nullptr);
+  BOOST_TEST(plans.save_wisdom(filename));
+  BOOST_TEST(plans.load_wisdom(filename));
+  BOOST_TEST(!plans.load_wisdom("this/file/does/not/exist"));
+  plans.set_rigor(rigor);
+  std::remove(filename.c_str());
+
+  BOOST_TEST((parse_fourier_rigor("patient") == FFTW_PATIENT));
+  BOOST_TEST((parse_fourier_rigor("estimate") == FFTW_ESTIMATE));
+  BOOST_TEST(!parse_fourier_rigor("anything else").has_value());
+}
+
+BOOST_AUTO_TEST_CASE(FourierBands_reduce)
+{
+  // Frequencies 0, 1, ..., 10
+  std::vector<double> frequencies(11);
+  for (size_t k = 0; k < frequencies.size(); ++k) {
+    frequencies[k] = k;
+  }
+  auto edges = FourierBands::log_edges(frequencies, 3);
+  BOOST_TEST_REQUIRE(edges.size() == 4u);
+  BOOST_TEST(edges.front() == 1);
+  BOOST_TEST(edges.back() == 10);
+
+  // The band [4.5, 4.8) is empty and goes into the next one
+  FourierBands bands(frequencies, { 0, 4.5, 4.8, 8, 10 });
+  BOOST_TEST_REQUIRE(bands.size() == 3u);
+  BOOST_TEST((bands.get_edges() == std::vector<double>{ 0, 4.5, 8, 10 }));
+  std::vector<double> magnitudes(frequencies.size(), 1);
+  magnitudes[5] = 7;
+  std::vector<float> out(bands.size());
+  bands.reduce(magnitudes.data(), out.data());
+  BOOST_TEST(out[0] == 1);
+  // Quadratic mean of 7, 1, 1 for the frequencies 5, 6 and 7
+  BOOST_TEST(out[1] == std::sqrt(17.f), boost::test_tools::tolerance(1e-6f));
+  // The last band includes its upper edge
+  BOOST_TEST(out[2] == 1);
+
+  BOOST_TEST(FourierBands(frequencies, {}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(FourierBands_half_precision)
+{
+  BOOST_TEST(float_to_half(1) == 0x3c00);
+  BOOST_TEST(float_to_half(-2) == 0xc000);
+  BOOST_TEST(float_to_half(65504) == 0x7bff);
+  BOOST_TEST(float_to_half(1e6) == 0x7c00);
+  BOOST_TEST(float_to_half(std::pow(2.f, -24)) == 0x0001);
+  // Halfway between 1 and the next half rounds to even
+  BOOST_TEST(float_to_half(1 + std::pow(2.f, -11)) == 0x3c00);
+  BOOST_TEST(float_to_half(1 + 3 * std::pow(2.f, -11)) == 0x3c02);
+  BOOST_TEST(std::isnan(half_to_float(float_to_half(std::nanf("")))));
+
+  // Every finite half survives the round trip
+  for (uint32_t half = 0; half < 0x10000; ++half) {
+    if ((half & 0x7c00) == 0x7c00) {
+      continue;
+    }
+    BOOST_TEST_REQUIRE(float_to_half(half_to_float(half)) == half);
+  }
+  // Saturated values stay finite
+  BOOST_TEST(float_to_half_saturated(1e6) == 0x7bff);
+  BOOST_TEST(float_to_half_saturated(-1e6) == 0xfbff);
+  BOOST_TEST(float_to_half_saturated(1) == 0x3c00);
+
+  // And the relative error of the conversion is at most 2^-11
+  std::mt19937 mt(1000007);
+  std::uniform_real_distribution<float> dist(1e-3, 6e4);
+  for (int i = 0; i < 1000; ++i) {
+    float value = dist(mt);
+    BOOST_TEST_REQUIRE(std::abs(half_to_float(float_to_half(value)) - value) <= value * std::pow(2.f, -11));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(FourierBands_half_precision_pedestal)
+{
+  // A pedestal of 900 makes the DC term of 2048 points about 1.8e6, and a
+  // window leaks part of it to the first frequencies. Divided by the number
+  // of points every value fits in half precision
+  int npoints = 2048;
+  FourierBatch<float> batch(1, npoints, 1e-6, FourierWindowType::kHann);
+  std::mt19937 mt(1000007);
+  std::normal_distribution<float> noise(900, 5);
+  std::vector<uint16_t> adcs(npoints);
+  for (auto& adc : adcs) {
+    adc = std::lround(noise(mt));
+  }
+  batch.fill(0, adcs.data());
+  BOOST_TEST_REQUIRE(batch.compute());
+  BOOST_TEST(batch.get_magnitudes(0)[0] > 65504);
+
+  auto frequencies = batch.get_frequencies();
+  FourierBands bands(frequencies, FourierBands::log_edges(frequencies, 64));
+  std::vector<float> values(bands.size());
+  bands.reduce(batch.get_magnitudes(0), values.data());
+  std::vector<float> spectrum(batch.get_magnitudes(0), batch.get_magnitudes(0) + frequencies.size());
+  for (auto* v : { &values, &spectrum }) {
+    for (auto& value : *v) {
+      value /= npoints;
+      BOOST_TEST_REQUIRE(std::isfinite(half_to_float(float_to_half(value))));
+    }
+  }
+  // The DC term is the mean of the windowed samples, half of the pedestal for Hann
+  BOOST_TEST(spectrum[0] == 450, boost::test_tools::tolerance(0.01f));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
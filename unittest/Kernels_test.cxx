@@ -0,0 +1,206 @@
+/**
+ * @file Kernels_test.cxx Unit Tests for the vectorized numeric kernels
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE Kernels_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "dqm/algs/Kernels.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace dunedaq::dqm;
+
+BOOST_AUTO_TEST_SUITE(Kernels_test)
+
+std::mt19937 mt(1000007);
+
+std::vector<KernelISA>
+supported_isas()
+{
+  std::vector<KernelISA> ret;
+  for (auto isa : { KernelISA::kScalar, KernelISA::kSSE42, KernelISA::kAVX2, KernelISA::kAVX512 }) {
+    if (isa <= detect_isa()) {
+      ret.push_back(isa);
+    }
+  }
+  return ret;
+}
+
+void
+Kernels_test_case(size_t n)
+{
+  std::uniform_int_distribution<uint16_t> dist(0, (1 << 14) - 1);
+  std::vector<uint16_t> adcs(n);
+  for (auto& adc : adcs) {
+    adc = dist(mt);
+  }
+
+  uint64_t ref_sum = 0, ref_sum_sq = 0;
+  std::vector<double> ref_acc(n, 0.5);
+  for (size_t i = 0; i < n; ++i) {
+    ref_sum += adcs[i];
+    ref_sum_sq += static_cast<uint64_t>(adcs[i]) * adcs[i];
+    ref_acc[i] += adcs[i];
+  }
+
+  for (auto isa : supported_isas()) {
+    const auto& kernels = get_kernels(isa);
+    uint64_t sum = 0, sum_sq = 0;
+    kernels.sum_row(adcs.data(), n, sum, sum_sq);
+    BOOST_TEST_REQUIRE(sum == ref_sum);
+    BOOST_TEST_REQUIRE(sum_sq == ref_sum_sq);
+
+    std::vector<double> acc(n, 0.5);
+    kernels.add_row(adcs.data(), n, acc.data());
+    for (size_t i = 0; i < n; ++i) {
+      BOOST_TEST_REQUIRE(acc[i] == ref_acc[i]);
+    }
+  }
+}
+
+void
+Summarize_test_case(size_t n, uint16_t full_scale)
+{
+  // Plenty of values at 0 and at full scale
+  std::uniform_int_distribution<int> dist(-50, full_scale + 50);
+  std::vector<uint16_t> adcs(n);
+  for (auto& adc : adcs) {
+    adc = std::clamp<int>(dist(mt), 0, full_scale);
+  }
+
+  RowSummary ref;
+  ref.min = 7; // Previous rows also count
+  for (auto adc : adcs) {
+    ref.sum += adc;
+    ref.sum_sq += static_cast<uint64_t>(adc) * adc;
+    ref.min = std::min(ref.min, adc);
+    ref.max = std::max(ref.max, adc);
+    ref.zeros += adc == 0;
+    ref.saturated += adc == full_scale;
+  }
+
+  for (auto isa : supported_isas()) {
+    RowSummary summary;
+    summary.min = 7;
+    get_kernels(isa).summarize_row(adcs.data(), n, full_scale, summary);
+    BOOST_TEST_REQUIRE(summary.sum == ref.sum);
+    BOOST_TEST_REQUIRE(summary.sum_sq == ref.sum_sq);
+    BOOST_TEST_REQUIRE(summary.min == ref.min);
+    BOOST_TEST_REQUIRE(summary.max == ref.max);
+    BOOST_TEST_REQUIRE(summary.zeros == ref.zeros);
+    BOOST_TEST_REQUIRE(summary.saturated == ref.saturated);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Kernels_test1)
+{
+  Kernels_test_case(1);
+}
+
+BOOST_AUTO_TEST_CASE(Kernels_test2)
+{
+  Kernels_test_case(1000);
+}
+
+BOOST_AUTO_TEST_CASE(Kernels_test3)
+{
+  // Not a multiple of any vector width
+  Kernels_test_case(65539);
+}
+
+BOOST_AUTO_TEST_CASE(Kernels_summarize)
+{
+  Summarize_test_case(1, (1 << 14) - 1);
+  Summarize_test_case(1000, (1 << 12) - 1);
+  // Long enough for the 16-bit lane counters to be flushed
+  Summarize_test_case(2000003, (1 << 14) - 1);
+
+  // Every value counts, which is the worst case for the lane counters
+  for (uint16_t value : { 0, (1 << 14) - 1 }) {
+    std::vector<uint16_t> adcs(1000003, value);
+    for (auto isa : supported_isas()) {
+      RowSummary summary;
+      get_kernels(isa).summarize_row(adcs.data(), adcs.size(), (1 << 14) - 1, summary);
+      BOOST_TEST_REQUIRE(summary.zeros == (value == 0 ? adcs.size() : 0));
+      BOOST_TEST_REQUIRE(summary.saturated == (value == 0 ? 0 : adcs.size()));
+      BOOST_TEST_REQUIRE(summary.min == value);
+      BOOST_TEST_REQUIRE(summary.max == value);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Kernels_window)
+{
+  // Not a multiple of any vector width
+  size_t n = 1003;
+  std::uniform_int_distribution<uint16_t> dist(0, (1 << 14) - 1);
+  std::uniform_real_distribution<double> weight(0, 1);
+  std::vector<uint16_t> adcs(n);
+  std::vector<double> window(n);
+  std::vector<float> window_float(n);
+  for (size_t i = 0; i < n; ++i) {
+    adcs[i] = dist(mt);
+    window[i] = weight(mt);
+    window_float[i] = window[i];
+  }
+
+  for (auto isa : supported_isas()) {
+    std::vector<double> out(n);
+    std::vector<float> out_float(n);
+    get_kernels(isa).window_row(adcs.data(), window.data(), n, out.data());
+    get_kernels(isa).window_row_float(adcs.data(), window_float.data(), n, out_float.data());
+    for (size_t i = 0; i < n; ++i) {
+      BOOST_TEST_REQUIRE(out[i] == adcs[i] * window[i]);
+      BOOST_TEST_REQUIRE(out_float[i] == adcs[i] * window_float[i]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Kernels_envelope)
+{
+  size_t n = 1003;
+  std::uniform_int_distribution<uint16_t> dist(0, (1 << 14) - 1);
+  std::vector<uint16_t> adcs(n);
+  for (auto& adc : adcs) {
+    adc = dist(mt);
+  }
+
+  // Buckets smaller and larger than the vector widths, the last one is not full
+  for (size_t bucket : { 1, 5, 16, 37, 100, 2000 }) {
+    size_t nbuckets = (n + bucket - 1) / bucket;
+    for (auto isa : supported_isas()) {
+      std::vector<uint16_t> out(2 * nbuckets);
+      get_kernels(isa).envelope_row(adcs.data(), n, bucket, out.data());
+      for (size_t b = 0; b < nbuckets; ++b) {
+        auto first = adcs.begin() + b * bucket;
+        auto last = adcs.begin() + std::min(n, (b + 1) * bucket);
+        BOOST_TEST_REQUIRE(out[2 * b] == *std::min_element(first, last));
+        BOOST_TEST_REQUIRE(out[2 * b + 1] == *std::max_element(first, last));
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Kernels_select)
+{
+  BOOST_TEST_REQUIRE((select_kernels(KernelISA::kScalar) == KernelISA::kScalar));
+  BOOST_TEST_REQUIRE((get_kernels().isa == KernelISA::kScalar));
+  BOOST_TEST_REQUIRE((select_kernels() == detect_isa()));
+  BOOST_TEST_REQUIRE((parse_isa_name("avx2") == KernelISA::kAVX2));
+  BOOST_TEST_REQUIRE((parse_isa_name("auto") == KernelISA::kAVX512));
+  BOOST_TEST_REQUIRE(!parse_isa_name("avx-2").has_value());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
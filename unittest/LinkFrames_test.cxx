@@ -0,0 +1,73 @@
+/**
+ * @file LinkFrames_test.cxx Unit Tests for the link-ordered frame containers
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE LinkFrames_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "dqm/LinkFrames.hpp"
+
+#include <memory>
+#include <vector>
+
+using namespace dunedaq::dqm;
+
+BOOST_AUTO_TEST_SUITE(LinkFrames_test)
+
+BOOST_AUTO_TEST_CASE(LinkIndex_slots)
+{
+  LinkIndex index({ 7, 3, 7, 100000, 0 });
+  BOOST_TEST(index.size() == 4);
+  BOOST_TEST(index.get_slot(7) == 0);
+  BOOST_TEST(index.get_slot(3) == 1);
+  BOOST_TEST(index.get_slot(100000) == 2);
+  BOOST_TEST(index.get_slot(0) == 3);
+  BOOST_TEST(index.get_slot(5) == -1);
+  BOOST_TEST(index.get_slot(-1) == -1);
+  BOOST_TEST(index.get_link(2) == 100000);
+}
+
+BOOST_AUTO_TEST_CASE(LinkFrames_order)
+{
+  std::vector<int> data(100);
+  auto index = std::make_shared<const LinkIndex>(std::vector<int>{ 1, 4, 9 });
+  LinkFrames<int> frames(index);
+
+  BOOST_TEST(frames.insert(9, FrameSpan<int>(data.data(), 10)));
+  BOOST_TEST(frames.insert(1, FrameSpan<int>(data.data() + 10, 20)));
+  BOOST_TEST(!frames.insert(2, FrameSpan<int>(data.data() + 30, 5)));
+  BOOST_TEST(frames.insert(4, FrameSpan<int>(data.data() + 40, 0)));
+
+  // Iteration is ordered by link regardless of the insertion order
+  std::vector<int> links;
+  for (const auto& [link, span] : frames) {
+    links.push_back(link);
+  }
+  BOOST_TEST((links == std::vector<int>({ 1, 4, 9 })));
+
+  BOOST_TEST((frames.find(2) == frames.end()));
+  BOOST_TEST(frames.at(1).size() == 20);
+  BOOST_TEST(frames.at(1)[3] == data.data() + 13);
+
+  frames.erase(frames.find(4));
+  BOOST_TEST(frames.size() == 2);
+  BOOST_TEST((frames.find(4) == frames.end()));
+  BOOST_TEST(frames.at(9).front() == data.data());
+
+  int count = 0;
+  for (auto frame : frames.at(9)) {
+    BOOST_TEST(frame == data.data() + count);
+    ++count;
+  }
+  BOOST_TEST(count == 10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,67 @@
+/**
+ * @file Mean_test.cxx Unit Tests for the mean and moving pedestal of many channels
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE Mean_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "dqm/algs/Mean.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using namespace dunedaq::dqm;
+
+BOOST_AUTO_TEST_SUITE(Mean_test)
+
+BOOST_AUTO_TEST_CASE(Mean_mean)
+{
+  Mean mean(2);
+  BOOST_TEST(mean.mean(0) == -1);
+  BOOST_TEST(mean.pedestal(0) == -1);
+  BOOST_TEST(mean.drift(0) == 0);
+
+  std::vector<uint16_t> adcs { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17 };
+  mean.fill(1, adcs.data(), adcs.size());
+  BOOST_TEST(mean.get_count(1) == adcs.size());
+  BOOST_TEST(mean.get_sum(1) == 153u);
+  BOOST_TEST(mean.mean(1) == 9);
+  BOOST_TEST(mean.mean(0) == -1);
+}
+
+BOOST_AUTO_TEST_CASE(Mean_moving_pedestal)
+{
+  Mean mean(1, 0.25);
+  std::vector<uint16_t> adcs(100, 800);
+  mean.fill(0, adcs.data(), adcs.size());
+  BOOST_TEST(mean.pedestal(0) == 800);
+  BOOST_TEST(mean.drift(0) == 0);
+
+  // The pedestal moves a quarter of the way to every new record
+  std::fill(adcs.begin(), adcs.end(), 900);
+  mean.fill(0, adcs.data(), adcs.size());
+  BOOST_TEST(mean.pedestal(0) == 825);
+  mean.fill(0, adcs.data(), adcs.size());
+  BOOST_TEST(mean.pedestal(0) == 843.75);
+  BOOST_TEST(mean.drift(0) == 43.75);
+  BOOST_TEST(mean.mean(0) == 2600. / 3);
+
+  // Only the sums are cleaned, the pedestal is kept across messages
+  mean.clean();
+  BOOST_TEST(mean.mean(0) == -1);
+  BOOST_TEST(mean.pedestal(0) == 843.75);
+
+  mean.reset();
+  BOOST_TEST(mean.pedestal(0) == -1);
+  BOOST_TEST(mean.drift(0) == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+/**
+ * @file Pipeline_test.cxx Unit Tests for the checks run on the decoded frames
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE Pipeline_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "dqm/Pipeline.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace dunedaq::dqm;
+
+BOOST_AUTO_TEST_SUITE(Pipeline_test)
+
+// Only the timestamp of the frames is used by the pipeline
+struct FakeFrame
+{
+  uint64_t timestamp;
+  uint64_t get_timestamp() const { return timestamp; }
+};
+
+// Frames of each link, with period 32 as for WIB2 frames
+std::vector<FakeFrame>
+make_frames(uint64_t first, size_t n)
+{
+  std::vector<FakeFrame> frames(n);
+  for (size_t i = 0; i < n; ++i) {
+    frames[i].timestamp = first + 32 * i;
+  }
+  return frames;
+}
+
+LinkFrames<FakeFrame>
+make_link_frames(std::vector<std::vector<FakeFrame>>& links)
+{
+  std::vector<int> ids;
+  for (size_t i = 0; i < links.size(); ++i) {
+    ids.push_back(i);
+  }
+  LinkFrames<FakeFrame> frames(std::make_shared<const LinkIndex>(ids));
+  for (size_t i = 0; i < links.size(); ++i) {
+    frames.insert(i, FrameSpan<FakeFrame>(links[i].data(), links[i].size()));
+  }
+  return frames;
+}
+
+BOOST_AUTO_TEST_CASE(Pipeline_align)
+{
+  std::vector<std::vector<FakeFrame>> links{ make_frames(1000, 100),
+                                             make_frames(1000 + 32 * 5, 100),
+                                             make_frames(1000 - 32 * 3, 90) };
+  auto frames = make_link_frames(links);
+  bool valid = StaticPipeline<FakeFrame, AlignTimestamps>()(frames);
+  BOOST_TEST(valid);
+
+  // The common window goes from the first frame of link 1 to the last one of link 2
+  for (const auto& [link, span] : frames) {
+    BOOST_TEST(span.size() == 82);
+    BOOST_TEST(span.front()->timestamp == 1000 + 32 * 5);
+    BOOST_TEST(span.back()->timestamp == 1000 + 32 * 86);
+  }
+  BOOST_TEST(frames.at(1).front() == links[1].data());
+}
+
+BOOST_AUTO_TEST_CASE(Pipeline_no_overlap)
+{
+  std::vector<std::vector<FakeFrame>> links{ make_frames(1000, 10), make_frames(1000 + 32 * 10, 10) };
+  auto frames = make_link_frames(links);
+  bool valid = StaticPipeline<FakeFrame, AlignTimestamps>()(frames);
+  BOOST_TEST(!valid);
+}
+
+BOOST_AUTO_TEST_CASE(Pipeline_no_common_frames)
+{
+  // The windows overlap but link 0 has a gap where link 1 has all its frames
+  std::vector<std::vector<FakeFrame>> links{ { { 1000 }, { 1000 + 32 * 20 } }, make_frames(1000 + 32 * 5, 6) };
+  auto frames = make_link_frames(links);
+  bool valid = StaticPipeline<FakeFrame, AlignTimestamps>()(frames);
+  BOOST_TEST(!valid);
+}
+
+BOOST_AUTO_TEST_CASE(Pipeline_fused_stages)
+{
+  std::vector<std::vector<FakeFrame>> links{ make_frames(1000, 50), {}, make_frames(1000, 40) };
+  auto frames = make_link_frames(links);
+  bool valid = StaticPipeline<FakeFrame, RemoveEmpty, CheckEmpty, MakeSameSize>()(frames);
+  BOOST_TEST(valid);
+  BOOST_TEST(frames.size() == 2);
+  BOOST_TEST(frames.at(0).size() == 40);
+
+  // The adapter built from names gives the same result
+  auto frames_by_name = make_link_frames(links);
+  BOOST_TEST(Pipeline<FakeFrame>({ "remove_empty", "check_empty", "make_same_size" })(frames_by_name));
+  BOOST_TEST(frames_by_name.size() == 2);
+  BOOST_TEST(frames_by_name.at(2).size() == 40);
+
+  std::vector<std::vector<FakeFrame>> empty_links{ {}, {} };
+  auto empty = make_link_frames(empty_links);
+  BOOST_TEST(!Pipeline<FakeFrame>({ "remove_empty", "check_empty" })(empty));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,114 @@
+/**
+ * @file PlanePower_test.cxx Unit Tests for the power spectrum averaged over planes
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE PlanePower_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "dqm/algs/FourierBatch.hpp"
+#include "dqm/algs/FourierWindow.hpp"
+#include "dqm/algs/PlanePower.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::dqm;
+
+BOOST_AUTO_TEST_SUITE(PlanePower_test)
+
+std::mt19937 mt(1000007);
+
+BOOST_AUTO_TEST_CASE(PlanePower_average)
+{
+  // Not a multiple of the block size and added from several threads
+  size_t nchannels = 3 * PlanePower::s_channels_per_block + 5;
+  int npoints = 256;
+  int nsamples = 250;
+  std::uniform_int_distribution<uint16_t> dist(0, (1 << 14) - 1);
+  std::vector<std::vector<uint16_t>> adcs(nchannels, std::vector<uint16_t>(nsamples));
+  std::vector<const uint16_t*> rows;
+  std::vector<int> groups;
+  FourierBatch<double> batch(nchannels, npoints, 0.5, FourierWindowType::kHann, nsamples);
+  for (size_t ch = 0; ch < nchannels; ++ch) {
+    for (auto& adc : adcs[ch]) {
+      adc = dist(mt);
+    }
+    batch.fill(ch, adcs[ch].data());
+    rows.push_back(adcs[ch].data());
+    // Every 4th channel is not in any plane
+    groups.push_back(ch % 4 == 3 ? -1 : ch % 4);
+  }
+  BOOST_TEST_REQUIRE(batch.compute());
+
+  PlanePower power(3, npoints, 0.5, FourierWindowType::kHann, nsamples);
+  std::vector<std::thread> threads;
+  for (size_t first = 0; first < nchannels; first += PlanePower::s_channels_per_block) {
+    size_t count = std::min(PlanePower::s_channels_per_block, nchannels - first);
+    threads.emplace_back([&, first, count] {
+      BOOST_TEST(power.add(rows.data() + first, groups.data() + first, count));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  BOOST_TEST(power.get_frequencies() == batch.get_frequencies());
+
+  size_t nfreq = power.get_num_frequencies();
+  std::vector<std::vector<double>> expected(4, std::vector<double>(nfreq, 0));
+  std::vector<int> counts(4, 0);
+  for (size_t ch = 0; ch < nchannels; ++ch) {
+    if (groups[ch] < 0) {
+      continue;
+    }
+    for (size_t k = 0; k < nfreq; ++k) {
+      double value = batch.get_magnitudes(ch)[k];
+      expected[groups[ch]][k] += value * value;
+      expected[3][k] += value * value;
+    }
+    counts[groups[ch]]++;
+    counts[3]++;
+  }
+  for (size_t group = 0; group < 3; ++group) {
+    BOOST_TEST(power.get_num_channels(group) == static_cast<uint64_t>(counts[group]));
+  }
+  for (size_t group = 0; group < 4; ++group) {
+    auto values = group < 3 ? power.get_power(group) : power.get_total_power();
+    for (size_t k = 0; k < nfreq; ++k) {
+      double value = expected[group][k] / counts[group];
+      // Single precision transforms
+      BOOST_TEST_REQUIRE(std::abs(values[k] - value) <= 1e-4 * value + 1e-2);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PlanePower_empty)
+{
+  PlanePower power(3, 100, 1);
+  std::vector<uint16_t> adcs(100, 1);
+  const uint16_t* row = adcs.data();
+  int group = 1;
+  BOOST_TEST(power.add(&row, &group, 1));
+  BOOST_TEST(power.get_power(0)[0] == -1);
+  // Constant samples only have a DC term
+  BOOST_TEST(power.get_power(1)[0] == 100 * 100);
+  BOOST_TEST(power.get_power(1)[1] == 0, boost::test_tools::tolerance(1e-6f));
+  BOOST_TEST(power.get_total_power()[0] == 100 * 100);
+
+  power.clean();
+  BOOST_TEST(power.get_num_channels(1) == 0u);
+  BOOST_TEST(power.get_total_power()[0] == -1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
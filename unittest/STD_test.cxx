@@ -18,6 +18,8 @@
 #include <vector>
 #include <random>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 
 using namespace dunedaq::dqm;
 
@@ -71,5 +73,64 @@ BOOST_AUTO_TEST_CASE(StDev_test5)
   StDev_test_case(100000, 0, 100000);
 }
 
+BOOST_AUTO_TEST_CASE(StDev_high_offset)
+{
+  // The textbook formula loses every significant digit here
+  StDev_test_case(1000000, 1e9, 1e9 + 1);
+}
+
+BOOST_AUTO_TEST_CASE(StDev_high_offset_exact)
+{
+  // Alternating values around a large offset have a known STD
+  int n = 1000000;
+  STD std;
+  for (int i = 0; i < n; ++i) {
+    std.fill(1e9 + (i % 2));
+  }
+  double expected = std::sqrt(0.25 * n / (n - 1));
+  BOOST_TEST_REQUIRE(std::abs(std.std() - expected) < 1e-6);
+  BOOST_TEST_REQUIRE(std::abs(std.mean() - (1e9 + 0.5)) < 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(StDev_merge)
+{
+  std::uniform_real_distribution<double> dist(1e8, 1e8 + 100);
+
+  // Split the same data in partial results of different sizes
+  STD all;
+  std::vector<STD> parts(7);
+  for (size_t i = 0; i < 100000; ++i) {
+    double num = dist(mt);
+    all.fill(num);
+    parts[(i * i) % parts.size()].fill(num);
+  }
+  STD merged;
+  merged.merge(STD());
+  for (auto& part : parts) {
+    merged.merge(part);
+  }
+  merged.merge(STD());
+  BOOST_TEST_REQUIRE(merged.m_nentries == all.m_nentries);
+  BOOST_TEST_REQUIRE(std::abs(merged.mean() - all.mean()) < 1e-6);
+  BOOST_TEST_REQUIRE(std::abs(merged.std() - all.std()) < 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(StDev_adc_blocks)
+{
+  // Blocks of ADC values, as they come from successive records, on a high pedestal
+  std::uniform_int_distribution<uint16_t> dist(16000, 16383);
+  STD blocks, values;
+  for (int block = 0; block < 20; ++block) {
+    std::vector<uint16_t> adcs(1000 + 37 * block);
+    for (auto& adc : adcs) {
+      adc = dist(mt);
+      values.fill(adc);
+    }
+    blocks.fill(adcs.data(), adcs.size());
+  }
+  BOOST_TEST_REQUIRE(blocks.m_nentries == values.m_nentries);
+  BOOST_TEST_REQUIRE(std::abs(blocks.std() - values.std()) < 1e-8);
+  BOOST_TEST_REQUIRE(std::abs(blocks.mean() - values.mean()) < 1e-8);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
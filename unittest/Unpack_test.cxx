@@ -0,0 +1,113 @@
+/**
+ * @file Unpack_test.cxx Unit Tests for the kernels that unpack whole frames
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE Unpack_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "dqm/FormatUtils.hpp"
+#include "dqm/algs/Unpack.hpp"
+
+#include "fddetdataformats/WIB2Frame.hpp"
+#include "fddetdataformats/WIBFrame.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+using namespace dunedaq::dqm;
+using dunedaq::fddetdataformats::WIB2Frame;
+using dunedaq::fddetdataformats::WIBFrame;
+
+BOOST_AUTO_TEST_SUITE(Unpack_test)
+
+std::mt19937 mt(1000007);
+
+void
+Unpack_WIB2_test_case(std::function<void(const uint32_t*, uint16_t*)> kernel, int nframes)
+{
+  std::uniform_int_distribution<uint16_t> dist(0, (1 << 14) - 1);
+
+  for (int iframe = 0; iframe < nframes; ++iframe) {
+    WIB2Frame frame {};
+    for (int ich = 0; ich < 256; ++ich) {
+      frame.set_adc(ich, dist(mt));
+    }
+    std::vector<uint16_t> out(256);
+    kernel(frame.adc_words, out.data());
+    for (int ich = 0; ich < 256; ++ich) {
+      BOOST_TEST_REQUIRE(out[ich] == frame.get_adc(ich));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Unpack_WIB2_scalar)
+{
+  Unpack_WIB2_test_case(unpack_wib2_scalar, 100);
+}
+
+BOOST_AUTO_TEST_CASE(Unpack_WIB2_sse42)
+{
+  if (!__builtin_cpu_supports("sse4.2")) {
+    return;
+  }
+  Unpack_WIB2_test_case(unpack_wib2_sse42, 100);
+}
+
+BOOST_AUTO_TEST_CASE(Unpack_WIB2_avx2)
+{
+  if (!__builtin_cpu_supports("avx2")) {
+    return;
+  }
+  Unpack_WIB2_test_case(unpack_wib2_avx2, 100);
+}
+
+BOOST_AUTO_TEST_CASE(Unpack_WIB2_avx512)
+{
+  if (!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("avx512bw")) {
+    return;
+  }
+  Unpack_WIB2_test_case(unpack_wib2_avx512, 100);
+}
+
+BOOST_AUTO_TEST_CASE(Unpack_WIB2_extreme_values)
+{
+  // All bits set and alternating patterns catch wrong masks and shifts
+  for (uint16_t value : { 0, (1 << 14) - 1, 0x2AAA, 0x1555 }) {
+    WIB2Frame frame {};
+    for (int ich = 0; ich < 256; ++ich) {
+      frame.set_adc(ich, value);
+    }
+    std::vector<uint16_t> out(256);
+    unpack_frame<WIB2Frame>(&frame, out.data());
+    for (int ich = 0; ich < 256; ++ich) {
+      BOOST_TEST_REQUIRE(out[ich] == frame.get_adc(ich));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Unpack_WIB)
+{
+  std::uniform_int_distribution<uint16_t> dist(0, (1 << 12) - 1);
+
+  WIBFrame frame {};
+  for (int ich = 0; ich < 256; ++ich) {
+    frame.set_channel(ich, dist(mt));
+  }
+  std::vector<uint16_t> out(256);
+  unpack_frame<WIBFrame>(&frame, out.data());
+  for (int ich = 0; ich < 256; ++ich) {
+    BOOST_TEST_REQUIRE(out[ich] == frame.get_channel(ich));
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
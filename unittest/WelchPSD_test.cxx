@@ -0,0 +1,132 @@
+/**
+ * @file WelchPSD_test.cxx Unit Tests for the power spectral density with Welch's method
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE WelchPSD_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "dqm/algs/WelchPSD.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace dunedaq::dqm;
+
+BOOST_AUTO_TEST_SUITE(WelchPSD_test)
+
+std::mt19937 mt(1000007);
+
+/**
+ * @brief Integral of the PSD over the frequencies, that has to be the variance
+ */
+double
+integrate(const WelchPSD& psd, size_t ch, double inc)
+{
+  auto values = psd.get_psd(ch);
+  double df = 1 / (inc * psd.get_segment_length());
+  double total = 0;
+  for (auto v : values) {
+    total += v * df;
+  }
+  return total;
+}
+
+BOOST_AUTO_TEST_CASE(WelchPSD_white_noise)
+{
+  // White noise on top of a pedestal: flat spectrum at 2 sigma^2 inc
+  double inc = 0.5e-6;
+  double sigma = 5;
+  WelchPSD psd(1, 128, 64, inc);
+  std::normal_distribution<double> dist(8000, sigma);
+  std::vector<uint16_t> adcs(128 * 40);
+  for (auto& adc : adcs) {
+    adc = std::lround(dist(mt));
+  }
+  psd.fill(0, adcs.data(), adcs.size());
+  BOOST_TEST(psd.get_num_segments(0) == 79);
+
+  // Rounding to integers adds 1/12 to the variance
+  double variance = sigma * sigma + 1. / 12;
+  BOOST_TEST(std::abs(integrate(psd, 0, inc) / variance - 1) < 0.05);
+
+  auto values = psd.get_psd(0);
+  double level = 0;
+  for (size_t k = 5; k < values.size() - 5; ++k) {
+    level += values[k];
+  }
+  level /= values.size() - 10;
+  BOOST_TEST(std::abs(level / (2 * variance * inc) - 1) < 0.05);
+  // The pedestal is removed from every segment
+  BOOST_TEST(values[0] < 2 * variance * inc);
+}
+
+BOOST_AUTO_TEST_CASE(WelchPSD_sine)
+{
+  // A sine of amplitude A that falls on bin 16 has power A^2 / 2
+  double inc = 1e-3;
+  int length = 256;
+  double amplitude = 100;
+  WelchPSD psd(2, length, length / 2, inc);
+  std::vector<double> values(length * 8);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = 1000 + amplitude * std::sin(2 * M_PI * 16 * i / length);
+  }
+  psd.fill(1, values.data(), values.size());
+  BOOST_TEST(psd.get_num_segments(0) == 0);
+  BOOST_TEST(psd.get_psd(0)[0] == -1);
+  BOOST_TEST(std::abs(integrate(psd, 1, inc) / (amplitude * amplitude / 2) - 1) < 1e-3);
+
+  auto spectrum = psd.get_psd(1);
+  size_t peak = std::max_element(spectrum.begin(), spectrum.end()) - spectrum.begin();
+  BOOST_TEST(peak == 16);
+  BOOST_TEST(std::abs(psd.get_frequencies()[peak] - 16 / (length * inc)) < 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(WelchPSD_records_and_merge)
+{
+  // Adding records one by one, or merging partial results, gives the same average
+  double inc = 1;
+  WelchPSD all(1, 64, 32, inc), merged(1, 64, 32, inc), part(1, 64, 32, inc);
+  std::uniform_int_distribution<uint16_t> dist(0, 4095);
+  for (int record = 0; record < 5; ++record) {
+    std::vector<uint16_t> adcs(64 * 3 + record * 17);
+    for (auto& adc : adcs) {
+      adc = dist(mt);
+    }
+    all.fill(0, adcs.data(), adcs.size());
+    part.clean();
+    part.fill(0, adcs.data(), adcs.size());
+    merged.merge(part);
+  }
+  BOOST_TEST_REQUIRE(all.get_num_segments(0) == merged.get_num_segments(0));
+  auto a = all.get_psd(0);
+  auto b = merged.get_psd(0);
+  for (size_t k = 0; k < a.size(); ++k) {
+    BOOST_TEST_REQUIRE(std::abs(a[k] - b[k]) <= 1e-5 * a[k]);
+  }
+
+  // Less samples than a segment are ignored
+  std::vector<uint16_t> few(63, 1);
+  all.fill(0, few.data(), few.size());
+  BOOST_TEST(all.get_num_segments(0) == merged.get_num_segments(0));
+}
+
+BOOST_AUTO_TEST_CASE(WelchPSD_header_fields)
+{
+  // 256 samples of 1 us give frequencies every 3906.25 Hz
+  WelchPSD psd(1, 256, 128, 1e-6);
+  BOOST_TEST(psd.get_header_fields() == "\"segment_length\": \"256\",\"nfreq\": \"129\",\"df\": \"3906.25\"");
+  BOOST_TEST(psd.get_frequencies()[1] == 3906.25, boost::test_tools::tolerance(1e-9));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+/**
+ * @file WorkerPool_test.cxx Unit Tests for the pool of threads used to process the links
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+/**
+ * @brief Name of this test module
+ */
+#define BOOST_TEST_MODULE WorkerPool_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include "dqm/WorkerPool.hpp"
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::dqm;
+
+BOOST_AUTO_TEST_SUITE(WorkerPool_test)
+
+BOOST_AUTO_TEST_CASE(WorkerPool_all_indices)
+{
+  for (int nthreads : { 1, 2, 8 }) {
+    WorkerPool pool(nthreads);
+    BOOST_TEST(pool.get_num_threads() == nthreads);
+    for (size_t n : { 0, 1, 5, 1000 }) {
+      std::vector<int> calls(n, 0);
+      pool.parallel_for(n, [&](size_t i) { calls[i]++; });
+      for (size_t i = 0; i < n; ++i) {
+        BOOST_TEST_REQUIRE(calls[i] == 1);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(WorkerPool_concurrent_callers)
+{
+  // Modules run in their own threads and share the pool
+  WorkerPool pool(4);
+  std::vector<std::vector<int>> results(6, std::vector<int>(500, 0));
+  std::vector<std::thread> callers;
+  for (size_t icaller = 0; icaller < results.size(); ++icaller) {
+    callers.emplace_back([&, icaller] {
+      for (int repeat = 0; repeat < 20; ++repeat) {
+        pool.parallel_for(results[icaller].size(), [&](size_t i) { results[icaller][i]++; });
+      }
+    });
+  }
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  for (const auto& result : results) {
+    for (auto value : result) {
+      BOOST_TEST_REQUIRE(value == 20);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(WorkerPool_exception)
+{
+  WorkerPool pool(4);
+  BOOST_CHECK_THROW(pool.parallel_for(100,
+                                      [](size_t i) {
+                                        if (i == 42) {
+                                          throw std::runtime_error("failure");
+                                        }
+                                      }),
+                    std::runtime_error);
+  // The pool can still be used afterwards
+  std::vector<int> calls(10, 0);
+  pool.parallel_for(calls.size(), [&](size_t i) { calls[i]++; });
+  BOOST_TEST((calls == std::vector<int>(10, 1)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()